@@ -27,22 +27,44 @@
 #include <vector>
 
 #include <spa/audio.h>
+#include <spa/audio_dsp.h>
 
 class gain_effect : public spa::plugin
 {
 public:
 	void run() override
 	{
-		for(unsigned i = 0; i < samplecount; ++i)
+		// the host may change gain from any thread, read it only once
+		gain_smoother.set_target(gain);
+		if(gain_smoother.steady())
 		{
-			out.left[i] = gain * in.left[i];
-			out.right[i] = gain * in.right[i];
+			const float g = gain_smoother.value();
+			spa::audio::gain(in.left, out.left, g, samplecount);
+			spa::audio::gain(in.right, out.right, g, samplecount);
+		}
+		else
+		{
+			// avoid zipper noise by ramping in chunks
+			float ramp[64];
+			for(unsigned pos = 0; pos < samplecount; pos += 64)
+			{
+				const unsigned n =
+					std::min(64u, samplecount - pos);
+				gain_smoother.render(ramp, n);
+				for(unsigned i = 0; i < n; ++i)
+				{
+					out.left[pos + i] =
+						ramp[i] * in.left[pos + i];
+					out.right[pos + i] =
+						ramp[i] * in.right[pos + i];
+				}
+			}
 		}
 	}
 
 public:	// FEATURE: make these private?
 	~gain_effect() override {}
-	gain_effect()
+	gain_effect() : gain_smoother(gain, 256)
 	{
 		gain.min = 0.0f;
 		gain.max = 1.0f;
@@ -57,8 +79,9 @@ private:
 
 	spa::audio::stereo::in in;
 	spa::audio::stereo::out out;
-	spa::audio::control_in<float> gain;
+	spa::audio::atomic_control_in<float> gain;
 	spa::audio::samplecount samplecount;
+	spa::audio::smoother<float> gain_smoother;
 
 	spa::port_ref_base& port(const char* path) override
 	{
@@ -96,9 +119,10 @@ public:
 
 	license_type license() const override { return license_type::gpl_3_0; }
 
-	struct port_names_t { const char** names; };
-	spa::simple_vec<spa::simple_str> port_names() const override {
-		return { "in", "out", "samplecount", "gain" };
+	const char* const* port_name_table() const override {
+		static const char* const names[] = {
+			"in", "out", "samplecount", "gain", nullptr };
+		return names;
 	}
 
 	gain_effect* instantiate() const override {
@@ -107,10 +131,10 @@ public:
 
 extern "C" {
 //! the main entry point
-const spa::descriptor* spa_descriptor(unsigned long )
+const spa::descriptor* spa_descriptor(unsigned long plugin_number)
 {
-	// we have only one plugin, ignore the number
-	return new gain_effect_descriptor;
+	// we have only one plugin
+	return plugin_number ? nullptr : new gain_effect_descriptor;
 }
 }
 
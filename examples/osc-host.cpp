@@ -37,11 +37,13 @@ class osc_host
 {
 	friend struct host_visitor;
 public:
-	osc_host(const char* library_name);
+	osc_host(const char* library_name, unsigned long plugin_number = 0);
 	~osc_host();
 
 	//! play the @p time'th time, i.e. 0, 1, 2...
 	void play(int time);
+	//! play silent input, the plugin should be skipped if possible
+	void play_silence();
 
 	//! Set the name of the library where the plugin is
 	void set_library_name(const std::string& name) { library_name = name; }
@@ -55,24 +57,52 @@ private:
 
 	bool init_plugin();
 	void shutdown_plugin();
+	//! run the plugin, or skip it if its output would be silent anyways
+	void run_plugin();
+	//! switch the plugin's OSC port to a ringbuffer of twice the size
+	void grow_ringbuffer();
 
 	using dlopen_handle_t = void*;
 	dlopen_handle_t lib = nullptr;
 	std::string library_name;
+	//! index of the plugin inside the library
+	unsigned long plugin_number;
 
 	constexpr static int buffersize_fix = 10;
 	unsigned buffersize;
-	std::vector<float> unprocessed_l, unprocessed_r,
+	spa::audio::aligned_buffer unprocessed_l, unprocessed_r,
 		processed_l, processed_r;
+	//! whether the outputs share the input buffers
+	bool in_place = false;
+	float* output_l() { return in_place ? unprocessed_l.data()
+		: processed_l.data(); }
+	float* output_r() { return in_place ? unprocessed_r.data()
+		: processed_r.data(); }
 
 	// for controls where we do not know the meaning (but the user will)
 	std::vector<float> unknown_controls;
 	std::unique_ptr<spa::audio::osc_ringbuffer> rb;
+	spa::audio::osc_ringbuffer_in* osc_port = nullptr;
+
+	// signal information of the audio ports
+	std::vector<spa::audio::signal_info*> inputs, outputs;
+	unsigned skipped = 0;
+	// tail reported by the plugin, if any
+	unsigned tail = spa::audio::tail_length::infinite;
+	bool decayed = false;
+	//! number of samples the plugin has been run with silent inputs
+	unsigned long silent_samples = 0;
+	// latency reported by the plugin, if any
+	unsigned latency = 0;
+	const spa::audio::latency* latency_port = nullptr;
+	unsigned long latency_revision = 0;
 
 //	std::map<std::string, port_base*> ports;
 };
 
-osc_host::osc_host(const char* library_name)
+osc_host::osc_host(const char* library_name,
+	unsigned long plugin_number) :
+	plugin_number(plugin_number)
 {
 	set_library_name(library_name);
 	if(init_plugin())
@@ -94,23 +124,104 @@ void osc_host::play(int time)
 		return;
 
 	// simulate automation from the host
-	rb->write("/gain", "f", fmodf(time/10.0f, 1.0f));
+	const float gain = fmodf(time/10.0f, 1.0f);
+	if(!rb->write("/gain", "f", gain))
+	{
+		grow_ringbuffer();
+		rb->write("/gain", "f", gain);
+	}
 
 	// provide audio input
 	for(unsigned i = 0; i < buffersize; ++i)
 	{
 		unprocessed_l[i] = unprocessed_r[i] = 0.1f;
 	}
+	for(spa::audio::signal_info* in : inputs)
+		in->set_signal(spa::audio::signal_t::constant, 0.1f);
 
 	// let the plugin work
-	plugin->run();
+	run_plugin();
 
 	// check output
+	const float* out_l = output_l();
+	const float* out_r = output_r();
 	for(unsigned i = 0; i < buffersize; ++i)
 	{
 		all_ok = all_ok &&
-			(fabsf(processed_l[i] - 0.01f * time) < 0.0001f) &&
-			(fabsf(processed_r[i] - 0.01f * time) < 0.0001f);
+			(fabsf(out_l[i] - 0.01f * time) < 0.0001f) &&
+			(fabsf(out_r[i] - 0.01f * time) < 0.0001f);
+	}
+}
+
+void osc_host::play_silence()
+{
+	if(!plugin)
+		return;
+
+	for(unsigned i = 0; i < buffersize; ++i)
+	{
+		unprocessed_l[i] = unprocessed_r[i] = 0.0f;
+	}
+	for(spa::audio::signal_info* in : inputs)
+		in->set_signal(spa::audio::signal_t::silent);
+
+	unsigned skipped_before = skipped;
+	run_plugin();
+
+	// the example plugin has no tail, so it must have been skipped
+	all_ok = all_ok && (skipped == skipped_before + 1);
+	const float* out_l = output_l();
+	const float* out_r = output_r();
+	for(unsigned i = 0; i < buffersize; ++i)
+		all_ok = all_ok && out_l[i] == 0.0f && out_r[i] == 0.0f;
+}
+
+void osc_host::run_plugin()
+{
+	for(spa::audio::signal_info* out : outputs)
+		out->set_signal(spa::audio::signal_t::normal);
+
+	bool inputs_silent = true;
+	for(spa::audio::signal_info* in : inputs)
+		inputs_silent = inputs_silent && in->silent();
+	bool no_events = !osc_port || !osc_port->read_space();
+
+	// events can excite the plugin like audio input does (e.g. note-on)
+	if(!inputs_silent || !no_events)
+		silent_samples = 0;
+	bool idle = descriptor->properties.no_tail || decayed ||
+		(tail != spa::audio::tail_length::infinite &&
+			silent_samples >= tail);
+
+	if(idle && inputs_silent && no_events)
+	{
+		// propagate the silence instead of running the plugin
+		// (a host with multiple plugins would continue checking
+		// the next plugins)
+		float* out_l = output_l();
+		float* out_r = output_r();
+		for(unsigned i = 0; i < buffersize; ++i)
+			out_l[i] = out_r[i] = 0.0f;
+		for(spa::audio::signal_info* out : outputs)
+			out->set_signal(spa::audio::signal_t::silent);
+		++skipped;
+	}
+	else
+	{
+		plugin->run();
+		// only count the frames after the last event, which may be
+		// anywhere in this block
+		if(inputs_silent && no_events)
+			silent_samples += buffersize;
+	}
+
+	if(latency_port && latency_port->revision() != latency_revision)
+	{
+		// a host with multiple plugins would now re-compute the
+		// delays of parallel paths
+		latency_revision = latency_port->revision();
+		std::cout << "plugin latency changed to " << latency
+			<< " samples" << std::endl;
 	}
 }
 
@@ -120,25 +231,53 @@ struct host_visitor : public virtual spa::audio::visitor
 	osc_host* h;
 	using spa::audio::visitor::visit;
 
+	//! tell the plugin about our buffers' alignment and padding
+	void set_contract(spa::audio::buffer_contract& p)
+	{
+		using buf = spa::audio::aligned_buffer;
+		p.alignment = buf::default_alignment;
+		p.padding = buf::default_padding;
+		if(!p.accepts(p.alignment, p.padding))
+			ok = false;
+	}
+
 	// TODO: forbid channel.operator= x ? (use channel class with set method)
 	virtual void visit(spa::audio::in& p) override {
 		printf("in, c: %d\n", p.channel);
+		set_contract(p);
+		h->inputs.push_back(&p);
 		p.set_ref((p.channel == spa::audio::stereo::left)
 			? h->unprocessed_l.data()
 			: h->unprocessed_r.data()); }
 	virtual void visit(spa::audio::out& p) override {
 		printf("out, c: %d\n", p.channel);
+		set_contract(p);
+		h->outputs.push_back(&p);
 		p.set_ref((p.channel == spa::audio::stereo::left)
-			? h->processed_l.data()
-			: h->processed_r.data()); }
+			? h->output_l()
+			: h->output_r()); }
 	virtual void visit(spa::audio::stereo::in& p) override {
 		std::cout << "in, stereo" << std::endl;
+		set_contract(p);
+		h->inputs.push_back(&p);
 		p.left = h->unprocessed_l.data();
 		p.right = h->unprocessed_r.data(); }
 	virtual void visit(spa::audio::stereo::out& p) override {
 		std::cout << "out, stereo" << std::endl;
-		p.left = h->processed_l.data();
-		p.right = h->processed_r.data(); }
+		set_contract(p);
+		h->outputs.push_back(&p);
+		p.left = h->output_l();
+		p.right = h->output_r(); }
+	virtual void visit(spa::audio::tail_length& p) override {
+		std::cout << "tail length" << std::endl;
+		p.set_ref(&h->tail); }
+	virtual void visit(spa::audio::decayed& p) override {
+		std::cout << "decayed" << std::endl;
+		p.set_ref(&h->decayed); }
+	virtual void visit(spa::audio::latency& p) override {
+		std::cout << "latency" << std::endl;
+		p.set_ref(&h->latency);
+		h->latency_port = &p; }
 	virtual void visit(spa::audio::buffersize& p) override {
 		std::cout << "buffersize" << std::endl;
 		p.set_ref(&h->buffersize); }
@@ -150,6 +289,7 @@ struct host_visitor : public virtual spa::audio::visitor
 			h->rb.reset(
 				new spa::audio::osc_ringbuffer(p.get_size()));
 			p.connect(*h->rb);
+			h->osc_port = &p;
 		}
 	}
 
@@ -194,22 +334,28 @@ bool osc_host::init_plugin()
 		return false;
 	}
 
-	if(descriptor_loader)
-	{
-		descriptor = (*descriptor_loader)(0 /* = plugin number, TODO */);
-		// TODO: use collection of descriptors?
-		spa::assert_versions_match(*descriptor);
-		if(descriptor)
-		 plugin = descriptor->instantiate();
+	// only constructs the descriptor that we need
+	descriptor = (*descriptor_loader)(plugin_number);
+	if(!descriptor) {
+		std::cerr << "Warning: No plugin number " << plugin_number
+			<< " in " << library_name << std::endl;
+		return false;
 	}
+	spa::assert_versions_match(*descriptor);
+	plugin = descriptor->instantiate();
 
 	// initialize all our port names before connecting...
 	buffersize = buffersize_fix;
 	// ... especially the buffers...
 	unprocessed_l.resize(buffersize);
 	unprocessed_r.resize(buffersize);
-	processed_l.resize(buffersize);
-	processed_r.resize(buffersize);
+	// plugins that can process in place save us a buffer and cache space
+	in_place = descriptor->properties.in_place;
+	if(!in_place)
+	{
+		processed_l.resize(buffersize);
+		processed_r.resize(buffersize);
+	}
 
 
 	const spa::simple_vec<spa::simple_str> port_names =
@@ -256,6 +402,15 @@ bool osc_host::init_plugin()
 	return true;
 }
 
+void osc_host::grow_ringbuffer()
+{
+	// we're not running the plugin concurrently, so it's safe to switch
+	std::unique_ptr<spa::audio::osc_ringbuffer> larger(
+		new spa::audio::osc_ringbuffer(osc_port->get_size() * 2));
+	osc_port->switch_to(*larger);
+	rb = std::move(larger);
+}
+
 void osc_host::shutdown_plugin()
 {
 	if(!plugin)
@@ -276,7 +431,8 @@ void osc_host::shutdown_plugin()
 
 void usage()
 {
-	std::cout << "usage: osc-host [<shared object library>]\n" << std::endl;
+	std::cout << "usage: osc-host [<shared object library> "
+		"[<plugin number>]]\n" << std::endl;
 	exit(0);
 }
 
@@ -284,6 +440,7 @@ int main(int argc, char** argv)
 {
 	int rc = EXIT_SUCCESS;
 	const char* library_name = nullptr;
+	unsigned long plugin_number = 0;
 	switch(argc)
 	{
 		case 1:
@@ -291,6 +448,9 @@ int main(int argc, char** argv)
 				" \"libosc-plugin.so\"..." << std::endl;
 			library_name = "libosc-plugin.so";
 			break;
+		case 3:
+			plugin_number = std::strtoul(argv[2], nullptr, 10);
+			// fall through
 		case 2:
 			library_name = argv[1];
 			break;
@@ -304,9 +464,10 @@ int main(int argc, char** argv)
 		if(realpath(library_name, abs_path))
 		{
 			library_name = abs_path;
-			osc_host host(library_name);
+			osc_host host(library_name, plugin_number);
 			for(int i = 0; i < 10; ++i)
 				host.play(i);
+			host.play_silence();
 			if(!host.ok())
 				throw std::runtime_error("Error while starting"
 							" or running the host");
@@ -25,9 +25,9 @@
 
 #include <cstring>
 #include <iostream>
-#include <vector>
 
 #include <spa/audio.h>
+#include <spa/audio_dsp.h>
 
 class example_plugin : public spa::plugin
 {
@@ -37,8 +37,6 @@ class example_plugin : public spa::plugin
 		int some_extra_value;
 		buffersize_port() : some_extra_value(0) {}
 	};
-	//! useless buffer, just for demonstration
-	std::vector<float> out_buffer_l, out_buffer_r;
 
 public:
 	void run() override
@@ -57,24 +55,27 @@ public:
 			}
 		}
 
-		for(unsigned i = 0; i < buffersize; ++i)
+		if(in.signal == spa::audio::signal_t::constant)
 		{
-			out_buffer_l[i] = gain * in.left[i];
-			out_buffer_r[i] = gain * in.right[i];
+			// fast path, and tell the host about it
+			const float value = gain * in.constant_value;
+			for(unsigned i = 0; i < buffersize; ++i)
+				out.left[i] = out.right[i] = value;
+			out.set_signal(spa::audio::signal_t::constant, value);
+			return;
 		}
 
-		memcpy(out.left, out_buffer_l.data(), buffersize * sizeof(out.left[0]));
-		memcpy(out.right, out_buffer_r.data(), buffersize * sizeof(out.right[0]));
-	}
-
-	void init() override {
-		out_buffer_l.resize(buffersize);
-		out_buffer_r.resize(buffersize);
+		// the kernels work in place, too
+		spa::audio::gain(in.left, out.left, gain, buffersize);
+		spa::audio::gain(in.right, out.right, gain, buffersize);
 	}
 
 public:	// FEATURE: make these private?
 	~example_plugin() override {}
-	example_plugin() : osc_in(1024) {}
+	example_plugin() : osc_in(1024) {
+		// we don't need it, but let's demonstrate it
+		in.required_alignment = out.required_alignment = 16;
+	}
 
 private:
 
@@ -105,7 +106,11 @@ class example_descriptor : public spa::descriptor
 {
 	SPA_DESCRIPTOR
 public:
-	example_descriptor() { properties.hard_rt_capable = 1; }
+	example_descriptor() {
+		properties.hard_rt_capable = 1;
+		properties.in_place = 1;
+		properties.no_tail = 1;
+	}
 
 	hoster_t hoster() const override { return hoster_t::github; }
 	const char* organization_url() const override {
@@ -124,9 +129,17 @@ public:
 
 	license_type license() const override { return license_type::gpl_3_0; }
 
-	struct port_names_t { const char** names; };
-	spa::simple_vec<spa::simple_str> port_names() const override {
-		return { "in", "out", "buffersize", "osc" };
+	const char* const* port_name_table() const override {
+		static const char* const names[] = {
+			"in", "out", "buffersize", "osc", nullptr };
+		return names;
+	}
+
+	// optional, saves hosts from hashing the identification
+	std::uint64_t id() const override {
+		constexpr std::uint64_t res = spa::plugin_id("github.com",
+			"JohannesLorenz", "spa", "master", "example-plugin");
+		return res;
 	}
 
 	example_plugin* instantiate() const override {
@@ -135,10 +148,10 @@ public:
 
 extern "C" {
 //! the main entry point
-const spa::descriptor* spa_descriptor(unsigned long )
+const spa::descriptor* spa_descriptor(unsigned long plugin_number)
 {
-	// we have only one plugin, ignore the number
-	return new example_descriptor;
+	// we have only one plugin
+	return plugin_number ? nullptr : new example_descriptor;
 }
 }
 
@@ -35,7 +35,10 @@
 #ifndef SPA_AUDIO_H
 #define SPA_AUDIO_H
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <new>
 #include <rtosc/pseudo-rtosc.h>
 
 #include "spa.h"
@@ -59,6 +62,129 @@ public:
 		args_found(args_found) {}
 };
 
+/*
+	buffer alignment
+*/
+
+//! Alignment and padding contract of audio buffer ports
+//! The plugin sets the required values (usually in its constructor), the
+//! host must provide buffers that fulfill them and tells the plugin what
+//! it actually provides when connecting. Then, plugins can use aligned,
+//! full width SIMD loops without handling the tail separately.
+class buffer_contract : public virtual port_ref_base
+{
+public:
+	//! alignment in bytes the plugin requires, 0 for none
+	unsigned required_alignment = 0;
+	//! The plugin requires to access the buffers up to the next multiple
+	//! of this number of samples, 0 for none. Input samples beyond the
+	//! sample count are unspecified, output samples are ignored.
+	unsigned required_padding = 0;
+
+	//! alignment in bytes the host provides, set by the host
+	unsigned alignment = 0;
+	//! padding in samples the host provides, set by the host
+	unsigned padding = 0;
+
+	//! whether buffers with @p alignment and @p padding are sufficient
+	bool accepts(unsigned alignment, unsigned padding) const
+	{
+		return (!required_alignment ||
+				(alignment && !(alignment % required_alignment)))
+			&& (!required_padding ||
+				(padding && !(padding % required_padding)));
+	}
+};
+
+//! let the compiler assume that @p ptr is aligned to @p Alignment bytes
+//! use this for buffers that are guaranteed by the buffer_contract
+template<std::size_t Alignment, class T>
+inline T* assume_aligned(T* ptr)
+{
+	return static_cast<T*>(__builtin_assume_aligned(ptr, Alignment));
+}
+
+//! audio buffer for the host, with configurable alignment and padding
+class aligned_buffer
+{
+	char* storage = nullptr;
+	float* _data = nullptr;
+	std::size_t len = 0;
+public:
+	//! alignment in bytes that hosts should use by default
+	static constexpr unsigned default_alignment = 64;
+	//! padding in samples that hosts should use by default
+	static constexpr unsigned default_padding = 16;
+
+	//! resize to @p size samples, rounded up to a multiple of @p padding
+	//! all samples are set to 0
+	//! @param alignment in bytes, 0 means the alignment of float
+	void resize(std::size_t size,
+		unsigned alignment = default_alignment,
+		unsigned padding = default_padding)
+	{
+		if(!alignment)
+			alignment = alignof(float);
+		const std::size_t new_len = padding
+			? (size + padding - 1) / padding * padding : size;
+		// if new throws, the old buffer is still valid
+		char* new_storage =
+			new char[new_len * sizeof(float) + alignment];
+		delete[] storage;
+		storage = new_storage;
+		len = new_len;
+		std::size_t addr = reinterpret_cast<std::size_t>(storage);
+		_data = reinterpret_cast<float*>(storage +
+			((alignment - addr % alignment) % alignment));
+		for(std::size_t i = 0; i < len; ++i)
+			_data[i] = 0.0f;
+	}
+
+	float* data() { return _data; }
+	const float* data() const { return _data; }
+	//! number of samples, including padding
+	std::size_t size() const { return len; }
+	float& operator[](std::size_t i) { return _data[i]; }
+	const float& operator[](std::size_t i) const { return _data[i]; }
+
+	aligned_buffer() = default;
+	aligned_buffer(const aligned_buffer& other) = delete;
+	aligned_buffer& operator=(const aligned_buffer& other) = delete;
+	~aligned_buffer() { delete[] storage; }
+};
+
+/*
+	signal information
+*/
+
+//! what the samples of an audio buffer contain in the current block
+enum class signal_t
+{
+	normal,  //!< anything
+	silent,  //!< all samples are 0
+	constant //!< all samples are signal_info::constant_value
+};
+
+//! Per block information about the samples of audio buffer ports
+//! The host sets it for inputs before each run(), and resets it to normal
+//! for outputs. The plugin may set it for outputs in run(). This allows
+//! to skip computations, e.g. plugins can take a fast path for silent
+//! inputs. The buffers must still contain the correct samples.
+class signal_info : public virtual port_ref_base
+{
+public:
+	signal_t signal = signal_t::normal;
+	//! value of all samples if signal is constant
+	float constant_value = 0.0f;
+
+	void set_signal(signal_t new_signal, float value = 0.0f)
+	{
+		signal = new_signal;
+		constant_value = value;
+	}
+	bool silent() const { return signal == signal_t::silent; }
+};
+
 /*
 	port types
 */
@@ -69,7 +195,7 @@ namespace stereo {
 	enum { left, right };
 
 	//! audio signal input
-	class in : public port_ref_base
+	class in : public buffer_contract, public signal_info
 	{
 	public:
 		SPA_OBJECT
@@ -81,7 +207,7 @@ namespace stereo {
 	};
 
 	//! audio signal output
-	class out : public port_ref_base
+	class out : public buffer_contract, public signal_info
 	{
 	public:
 		SPA_OBJECT
@@ -93,17 +219,108 @@ namespace stereo {
 	};
 } // namespace stereo
 
+namespace bus {
+
+	//! memory layout of the samples of a bus
+	enum class layout_t
+	{
+		//! one buffer per channel
+		planar,
+		//! one single buffer, containing one frame after the other
+		interleaved
+	};
+
+	//! audio signal input with any number of channels, e.g. for
+	//! surround or ambisonics
+	class in : public buffer_contract, public signal_info
+	{
+	public:
+		SPA_OBJECT
+
+		//! number of channels, set by the plugin
+		const unsigned channels;
+		//! layout the plugin expects, set by the plugin
+		const layout_t layout;
+		//! one pointer per channel (planar) or one pointer
+		//! (interleaved), set by the host
+		//! The host can exchange the whole table before each run()
+		const float* const* data = nullptr;
+
+		in(unsigned channels, layout_t layout = layout_t::planar) :
+			channels(channels), layout(layout) {}
+
+		//! buffer of channel @p c, for planar layout only
+		const float* channel(unsigned c) const { return data[c]; }
+
+		int directions() const override { return direction_t::input; }
+	};
+
+	//! audio signal output with any number of channels
+	class out : public buffer_contract, public signal_info
+	{
+	public:
+		SPA_OBJECT
+
+		//! number of channels, set by the plugin
+		const unsigned channels;
+		//! layout the plugin expects, set by the plugin
+		const layout_t layout;
+		//! one pointer per channel (planar) or one pointer
+		//! (interleaved), set by the host
+		//! The host can exchange the whole table before each run()
+		float* const* data = nullptr;
+
+		out(unsigned channels, layout_t layout = layout_t::planar) :
+			channels(channels), layout(layout) {}
+
+		//! buffer of channel @p c, for planar layout only
+		float* channel(unsigned c) const { return data[c]; }
+
+		int directions() const override {
+			return direction_t::output; }
+	};
+} // namespace bus
+
 //! audio signal input
 class in : public virtual port_ref<const float>, public virtual counted,
-	public virtual input
+	public virtual input, public virtual buffer_contract,
+	public virtual signal_info
 {
 	SPA_OBJECT
 };
 
 //! audio signal input
 class out : public port_ref<float>, public virtual counted,
-	public virtual output
+	public virtual output, public virtual buffer_contract,
+	public virtual signal_info
+{
+	SPA_OBJECT
+};
+
+//! packed signed 24 bit integer sample, little endian
+struct int24_t
+{
+	uint8_t bytes[3];
+};
+
+//! audio signal input of other sample types than float, e.g. double,
+//! int16_t, int24_t or int32_t. Integers use their full range.
+template<class T>
+class sample_in : public virtual port_ref<const T>, public virtual counted,
+	public virtual input, public virtual buffer_contract,
+	public virtual signal_info
+{
+public:
+	SPA_OBJECT
+};
+
+//! audio signal output of other sample types than float
+template<class T>
+class sample_out : public virtual port_ref<T>, public virtual counted,
+	public virtual output, public virtual buffer_contract,
+	public virtual signal_info
 {
+public:
 	SPA_OBJECT
 };
 
@@ -133,8 +350,85 @@ public:
 		step(static_cast<T>(1)) {}
 };
 
+//! one segment of sample accurate automation
+template<class T>
+struct control_segment
+{
+	//! first frame of the segment, relative to the start of the block
+	uint32_t offset;
+	//! number of frames to ramp linearly to target, 0 to set it instantly
+	uint32_t frames;
+	//! value reached at frame offset + frames
+	T target;
+};
+
+//! control_in port that additionally receives sample accurate automation
+//! Before each run(), the host provides the segments of this block,
+//! sorted by offset, non-overlapping, and within the block (the host must
+//! split longer ramps). The port's value is the value at the block start.
+//! Hosts that don't know this port can still connect it as a control_in.
+template<class T>
+class automatable_in : public virtual control_in<T>
+{
+public:
+	SPA_OBJECT
+
+	//! automation segments of the current block, set by the host
+	const control_segment<T>* segments = nullptr;
+	//! number of automation segments of the current block
+	unsigned segment_count = 0;
+
+	//! whether the value does not change during this block
+	bool steady() const { return !segment_count; }
+
+	//! write the automated values of the block's @p n frames into @p dst
+	void render(T* dst, unsigned n) const
+	{
+		T value = *this;
+		unsigned pos = 0;
+		for(unsigned s = 0; s < segment_count; ++s)
+		{
+			const control_segment<T>& seg = segments[s];
+			for(; pos < seg.offset; ++pos)
+				dst[pos] = value;
+			if(seg.frames)
+			{
+				// one vectorizable loop per segment
+				const T start = value;
+				const T step = (seg.target - start) / seg.frames;
+				for(unsigned i = 0; i < seg.frames; ++i)
+					dst[pos + i] = start + step * (i + 1);
+				pos += seg.frames;
+			}
+			value = seg.target;
+		}
+		for(; pos < n; ++pos)
+			dst[pos] = value;
+	}
+};
+
+//! like control_in, but the host can change the value from any thread
+//! @see atomic_port_ref
+template<class T>
+class atomic_control_in : public virtual atomic_port_ref<T>,
+	public virtual input
+{
+public:
+	SPA_OBJECT
+	scale_type_t scale_type;
+	T min;
+	T max;
+	T step;
+	T def;
+	atomic_control_in() :
+		scale_type(scale_type_t::linear),
+		min(std::numeric_limits<T>::min()),
+		max(std::numeric_limits<T>::max()),
+		step(static_cast<T>(1)) {}
+};
+
 template<class T>
-class control_out : public virtual port_ref<T>, public virtual input
+class control_out : public virtual port_ref<T>, public virtual output
 {
 public:
 	SPA_OBJECT
@@ -147,6 +441,231 @@ public:
 		max(std::numeric_limits<T>::max()) {}
 };
 
+//! how a smoother approaches its target
+enum class smoothing_t
+{
+	//! reach the target in a fixed number of samples. For
+	//! scale_type_t::logartihmic, the ramp is linear on the log scale
+	linear,
+	//! one pole lowpass, approaching the target by a constant factor
+	exponential
+};
+
+//! Smooths a control value (e.g. of a control_in port) over multiple
+//! samples to avoid zipper noise. Usage in run():
+//!   * call set_target() once per block
+//!   * if steady(), just use value() for the whole block (no extra cost)
+//!   * otherwise, let render() compute a ramp into a buffer
+template<class T>
+class smoother
+{
+	scale_type_t scale;
+	smoothing_t type;
+	unsigned length; //!< ramp length, or time constant, in samples
+	T cur, target;
+	T step = 0;
+	T coeff; //!< for exponential smoothing
+	unsigned remaining = 0; //!< for linear ramps
+	bool initialized = false;
+
+	bool geometric() const {
+		return scale == scale_type_t::logartihmic
+			&& cur > 0 && target > 0; }
+public:
+	//! @param samples ramp length for linear smoothing, time constant
+	//!   for exponential smoothing
+	smoother(unsigned samples, smoothing_t type = smoothing_t::linear,
+		scale_type_t scale = scale_type_t::linear) :
+		scale(scale), type(type), length(samples ? samples : 1),
+		cur(0), target(0),
+		coeff(static_cast<T>(std::exp(-1.0 / length))) {}
+
+	//! use the scale type of @p port, e.g. a control_in
+	template<class Port>
+	smoother(const Port& port, unsigned samples,
+		smoothing_t type = smoothing_t::linear) :
+		smoother(samples, type, port.scale_type) {}
+
+	//! jump to @p value without smoothing
+	void reset(T value)
+	{
+		cur = target = value;
+		remaining = 0;
+		initialized = true;
+	}
+
+	//! set a new target. The first target is being jumped to directly.
+	void set_target(T value)
+	{
+		if(!initialized)
+			reset(value);
+		else if(value != target)
+		{
+			target = value;
+			remaining = length;
+			if(type == smoothing_t::linear)
+				step = geometric()
+					? static_cast<T>(std::pow(
+						target / cur, 1.0 / length))
+					: (target - cur) / length;
+		}
+	}
+
+	//! whether the value does not change in the next samples
+	bool steady() const { return cur == target; }
+	//! the current value
+	T value() const { return cur; }
+
+	//! write the next @p n values into @p dst and advance
+	void render(T* dst, unsigned n)
+	{
+		unsigned i = 0;
+		if(type == smoothing_t::exponential)
+		{
+			// stop when the difference is below audible precision
+			const T eps = static_cast<T>(1e-5) *
+				std::max(std::abs(target), static_cast<T>(1));
+			T c = cur;
+			for(; i < n && std::abs(c - target) > eps; ++i)
+				dst[i] = c = target + (c - target) * coeff;
+			cur = (i < n) ? target : c;
+		}
+		else if(remaining)
+		{
+			unsigned len = std::min(n, remaining);
+			const T start = cur;
+			if(geometric())
+			{
+				T v = start;
+				for(; i < len; ++i)
+					dst[i] = v *= step;
+			}
+			else
+			{
+				// no loop carried dependency => vectorizable
+				for(; i < len; ++i)
+					dst[i] = start + step * (i + 1);
+			}
+			remaining -= len;
+			cur = remaining ? dst[len - 1] : target;
+		}
+		for(; i < n; ++i)
+			dst[i] = target;
+	}
+};
+
+class param_block_in;
+
+//! parameter block instance for the host, see param_block_in
+class param_block
+{
+	friend class param_block_in;
+
+	unsigned count;
+	char* storage; //!< allocated memory, holding values and dirty
+	std::atomic<float>* values; //!< aligned to a cache line
+	std::atomic<uint64_t>* dirty;
+
+	static unsigned words(unsigned count) { return (count + 63) / 64; }
+	//! offset of dirty behind values
+	//! the sizes of float and uint64_t are powers of 2, so rounding to 8
+	//! keeps dirty aligned
+	static std::size_t dirty_offset(unsigned count) {
+		return (count * sizeof(std::atomic<float>) + 7) / 8 * 8; }
+public:
+	//! create a block of @p count parameters, all being 0 and dirty
+	param_block(unsigned count) :
+		count(count),
+		storage(new char[63 + dirty_offset(count)
+			+ words(count) * sizeof(std::atomic<uint64_t>)])
+	{
+		std::size_t addr = reinterpret_cast<std::size_t>(storage);
+		char* aligned = storage + ((64 - addr % 64) % 64);
+		values = reinterpret_cast<std::atomic<float>*>(aligned);
+		for(unsigned i = 0; i < count; ++i)
+			new (values + i) std::atomic<float>(0.0f);
+		dirty = reinterpret_cast<std::atomic<uint64_t>*>(
+			aligned + dirty_offset(count));
+		for(unsigned w = 0; w < words(count); ++w)
+		{
+			unsigned bits = count - w * 64;
+			new (dirty + w) std::atomic<uint64_t>(bits >= 64
+				? ~static_cast<uint64_t>(0)
+				: (static_cast<uint64_t>(1) << bits) - 1);
+		}
+	}
+	param_block(const param_block& other) = delete;
+	~param_block() { delete[] storage; }
+
+	unsigned size() const { return count; }
+
+	//! set parameter @p idx to @p value and mark it as changed
+	//! can be called from any thread
+	void set(unsigned idx, float value)
+	{
+		values[idx].store(value, std::memory_order_relaxed);
+		dirty[idx / 64].fetch_or(static_cast<uint64_t>(1) << (idx % 64),
+			std::memory_order_release);
+	}
+
+	float get(unsigned idx) const {
+		return values[idx].load(std::memory_order_relaxed); }
+};
+
+//! port for a large number of float parameters in one contiguous, cache
+//! line aligned array, with one dirty bit per parameter
+//! The plugin can scan the dirty bits once per block and only recompute
+//! what depends on changed parameters, instead of polling every control.
+class param_block_in : public input
+{
+	unsigned count;
+	const std::atomic<float>* values = nullptr;
+	std::atomic<uint64_t>* dirty = nullptr;
+public:
+	SPA_OBJECT
+
+	//! @param count number of parameters that the plugin provides
+	param_block_in(unsigned count) : count(count) {}
+
+	unsigned size() const { return count; }
+
+	//! connect the port to a host's parameter block of the same size
+	void connect(param_block& block)
+	{
+		if(count != block.count)
+		 throw exception("connecting parameter blocks "
+			"of incompatible sizes");
+		values = block.values;
+		dirty = block.dirty;
+	}
+
+	//! return the current value of parameter @p idx
+	float operator[](unsigned idx) const {
+		return values[idx].load(std::memory_order_relaxed); }
+
+	//! call @p f(index, value) for each parameter that changed since
+	//! the last call, and mark them as unchanged
+	template<class F>
+	void for_each_changed(F f)
+	{
+		for(unsigned w = 0; w < (count + 63) / 64; ++w)
+		{
+			// cheap check first, to not write to unchanged words
+			if(!dirty[w].load(std::memory_order_relaxed))
+				continue;
+			uint64_t bits = dirty[w].exchange(0,
+				std::memory_order_acquire);
+			for(; bits; bits &= bits - 1)
+			{
+				unsigned idx = w * 64 + static_cast<unsigned>(
+					__builtin_ctzll(bits));
+				f(idx, values[idx].load(
+					std::memory_order_relaxed));
+			}
+		}
+	}
+};
+
 class samplerate : public virtual control_in<long> {
 	SPA_OBJECT
 	bool initial() const override { return true; }
@@ -164,19 +683,62 @@ class samplecount : public virtual control_in<unsigned> {
 	bool compulsory() const override { return false; }
 };
 
+//! reports for how many samples the outputs can still be non-silent after
+//! all inputs have become silent (e.g. a reverb's tail)
+//! The plugin may change it in run(), e.g. if the reverb time changes.
+//! Together with signal_info, this lets hosts stop running idle plugins.
+class tail_length : public virtual control_out<unsigned> {
+	SPA_OBJECT
+public:
+	//! value for plugins that may never become silent
+	static constexpr unsigned infinite =
+		std::numeric_limits<unsigned>::max();
+};
+
+//! optional port where the plugin reports in run() whether its outputs
+//! have decayed, i.e. they will stay silent while the inputs are silent
+//! and no events arrive. This can be earlier than the tail_length.
+class decayed : public virtual control_out<bool> {
+	SPA_OBJECT
+};
+
+//! reports the plugin's processing latency in samples (e.g. for lookahead
+//! limiters), so the host can compensate delays of parallel paths
+//! The plugin must only change it using report(), which allows the host
+//! to notice changes by comparing revision() after run()
+class latency : public virtual control_out<unsigned> {
+	SPA_OBJECT
+	unsigned long _revision = 0;
+public:
+	//! set the latency to @p samples, notifying the host on changes
+	void report(unsigned samples)
+	{
+		if(samples != static_cast<const unsigned&>(*this))
+		{
+			set(samples);
+			++_revision;
+		}
+	}
+	//! counter that changes whenever the latency changes
+	unsigned long revision() const { return _revision; }
+};
+
 //! ringbuffer instance for the host
 class osc_ringbuffer : public ringbuffer<char>
 {
 	using base = ringbuffer<char>;
 public:
-	void write(const char *dest, const char *args, ...)
+	//! write an OSC message
+	//! @return false iff the ringbuffer was full
+	bool write(const char *dest, const char *args, ...)
 	{
 		va_list va;
 		va_start(va,args);
-		write(dest, args, va);
+		bool res = write(dest, args, va);
 		va_end(va);
+		return res;
 	}
-	void write(const char *dest, const char *args, va_list va)
+	bool write(const char *dest, const char *args, va_list va)
 	{
 		// TODO: => move to cpp file
 		// TODO: check iwyu?
@@ -184,7 +746,7 @@ public:
 		pseudo_rtosc::rtosc_vmessage(write_buffer, max_msg,
 			dest, args, va);
 
-		write_with_length(write_buffer, len);
+		return write_with_length(write_buffer, len);
 	}
 
 	osc_ringbuffer(std::size_t size, std::size_t max_msg = 1024) :
@@ -222,6 +784,113 @@ public:
 	char* read_buffer; // TODO: smash?
 };
 
+//! configuration of one lane of an osc_lanes_in port
+struct osc_lane_t
+{
+	std::size_t size;    //!< size of the lane's ringbuffer
+	std::size_t max_msg; //!< maximum size of one message in this lane
+	//! maximum number of messages read from this lane per block, 0 = any
+	std::size_t max_msgs;
+	//! maximum number of bytes read from this lane per block, 0 = any
+	//! @note the first message of a block is always read, even if it
+	//!   exceeds this budget, so large messages can not block a lane
+	std::size_t max_bytes;
+};
+
+//! OSC input port consisting of multiple ringbuffers ("lanes"), e.g. one
+//! for control messages, one for note events and one for bulk data
+//! Lanes are drained in order of their index, so lane 0 always has the
+//! highest priority. Each lane can limit how much it may be read per block,
+//! such that bulk transfers are being spread over multiple blocks.
+class osc_lanes_in : public input
+{
+	struct lane_state
+	{
+		std::size_t max_msgs, max_bytes;
+		std::size_t msgs_read, bytes_read;
+	};
+
+	osc_ringbuffer_in** lanes;
+	lane_state* states;
+	unsigned count;
+	unsigned cur = 0; //!< lane of the last read message
+
+	bool in_budget(const lane_state& st, std::size_t len) const
+	{
+		return (!st.max_msgs || st.msgs_read < st.max_msgs) &&
+			(!st.max_bytes || !st.bytes_read ||
+				st.bytes_read + len <= st.max_bytes);
+	}
+public:
+	SPA_OBJECT
+
+	osc_lanes_in(const osc_lane_t* lane_cfg, unsigned count) :
+		lanes(new osc_ringbuffer_in*[count]),
+		states(new lane_state[count]),
+		count(count)
+	{
+		for(unsigned i = 0; i < count; ++i)
+		{
+			lanes[i] = new osc_ringbuffer_in(lane_cfg[i].size,
+				lane_cfg[i].max_msg);
+			states[i] = lane_state { lane_cfg[i].max_msgs,
+				lane_cfg[i].max_bytes, 0, 0 };
+		}
+	}
+	osc_lanes_in(const osc_lanes_in& other) = delete;
+	~osc_lanes_in() override
+	{
+		for(unsigned i = 0; i < count; ++i)
+			delete lanes[i];
+		delete[] lanes;
+		delete[] states;
+	}
+
+	//! number of lanes, for the host to connect
+	unsigned lane_count() const { return count; }
+	//! lane number @p i, for the host to connect
+	osc_ringbuffer_in& lane(unsigned i) { return *lanes[i]; }
+
+	//! read the next message with the highest priority that is still in
+	//! its lane's budget into the temporary buffer of its lane
+	//! @return true iff there was a next message. If false is returned,
+	//!   the budgets of all lanes are renewed for the next block.
+	bool read_msg()
+	{
+		for(unsigned i = 0; i < count; ++i)
+		{
+			lane_state& st = states[i];
+			std::size_t len = lanes[i]->next_msg_length();
+			if(len && in_budget(st, len))
+			{
+				lanes[i]->read_msg();
+				++st.msgs_read;
+				st.bytes_read += len;
+				cur = i;
+				return true;
+			}
+		}
+		reset_budgets();
+		return false;
+	}
+
+	//! renew the budgets of all lanes, e.g. if a plugin stops reading
+	//! before read_msg() returned false
+	void reset_budgets()
+	{
+		for(unsigned i = 0; i < count; ++i)
+			states[i].msgs_read = states[i].bytes_read = 0;
+	}
+
+	//! lane that the last message has been read from
+	unsigned lane() const { return cur; }
+
+	const char* path() const { return lanes[cur]->path(); }
+	const char* types() const { return lanes[cur]->types(); }
+	pseudo_rtosc::rtosc_arg_t arg(unsigned i) const {
+		return lanes[cur]->arg(i); }
+};
+
 //! ringbuffer out port for plugins to reference a host ringbuffer
 class osc_ringbuffer_out : public ringbuffer_out<char>
 {
@@ -248,6 +917,7 @@ public:
 
 #define SPA_MK_VISIT_AUDIO(type) \
 	SPA_MK_VISIT(control_in<type>, port_ref<const type>) \
+	SPA_MK_VISIT(atomic_control_in<type>, atomic_port_ref<type>) \
 	SPA_MK_VISIT(control_out<type>, port_ref<type>)
 
 #define SPA_MK_VISIT_AUDIO2(type) \
@@ -263,20 +933,38 @@ public:
 	SPA_MK_VISIT_AUDIO(float)
 	SPA_MK_VISIT_AUDIO(double)
 
+	SPA_MK_VISIT(automatable_in<float>, control_in<float>)
+	SPA_MK_VISIT(automatable_in<double>, control_in<double>)
+
 #undef SPA_MK_VISIT_AUDIO2
 #undef SPA_MK_VISIT_AUDIO
 
 	SPA_MK_VISIT(audio::stereo::in, port_ref_base)
 	SPA_MK_VISIT(audio::stereo::out, port_ref_base)
+	SPA_MK_VISIT(audio::bus::in, port_ref_base)
+	SPA_MK_VISIT(audio::bus::out, port_ref_base)
 
 	SPA_MK_VISIT(osc_ringbuffer_in, ringbuffer_in<char>)
+	SPA_MK_VISIT(osc_lanes_in, port_ref_base)
+	SPA_MK_VISIT(param_block_in, port_ref_base)
 	SPA_MK_VISIT(osc_ringbuffer_out, ringbuffer_out<char>)
 
 	SPA_MK_VISIT(in, port_ref<const float>)
 	SPA_MK_VISIT(out, port_ref<float>)
+	SPA_MK_VISIT(sample_in<double>, port_ref<const double>)
+	SPA_MK_VISIT(sample_out<double>, port_ref<double>)
+	SPA_MK_VISIT(sample_in<int16_t>, port_ref<const int16_t>)
+	SPA_MK_VISIT(sample_out<int16_t>, port_ref<int16_t>)
+	SPA_MK_VISIT(sample_in<int24_t>, port_ref_base)
+	SPA_MK_VISIT(sample_out<int24_t>, port_ref_base)
+	SPA_MK_VISIT(sample_in<int32_t>, port_ref<const int32_t>)
+	SPA_MK_VISIT(sample_out<int32_t>, port_ref<int32_t>)
 	SPA_MK_VISIT(samplerate, control_in<long>)
 	SPA_MK_VISIT(buffersize, control_in<unsigned>)
 	SPA_MK_VISIT(samplecount, control_in<unsigned>)
+	SPA_MK_VISIT(tail_length, control_out<unsigned>)
+	SPA_MK_VISIT(decayed, control_out<bool>)
+	SPA_MK_VISIT(latency, control_out<unsigned>)
 
 	virtual ~visitor();
 };
@@ -287,6 +975,10 @@ public:
 #define ACCEPT_SPA_AUDIO_T(classname) ACCEPT_T(classname, spa::audio::visitor)
 
 ACCEPT_SPA_AUDIO_T(control_in)
+ACCEPT_SPA_AUDIO_T(atomic_control_in)
+ACCEPT_SPA_AUDIO_T(automatable_in)
+ACCEPT_SPA_AUDIO_T(sample_in)
+ACCEPT_SPA_AUDIO_T(sample_out)
 ACCEPT_SPA_AUDIO_T(control_out)
 
 #undef ACCEPT_SPA_AUDIO_T
@@ -0,0 +1,130 @@
+/*************************************************************************/
+/* spa - simple plugin API                                               */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file audio_dsp.h
+	vectorized dsp kernels for audio plugins and hosts
+*/
+
+#ifndef SPA_AUDIO_DSP_H
+#define SPA_AUDIO_DSP_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "audio_fwd.h"
+
+namespace spa {
+namespace audio {
+
+/*
+	instruction sets
+*/
+
+//! instruction set that the kernels use
+enum class simd_t
+{
+	scalar,
+	sse2,
+	avx2,
+	avx512
+};
+
+//! return the instruction set that the kernels currently use
+//! by default, this is the best one that the CPU supports
+simd_t simd();
+
+//! let the kernels use @p level, or the best supported level below it,
+//! e.g. for benchmarks. Can be called while other threads run kernels;
+//! calls that already started finish with the previous level.
+//! @return the level that is being used now
+simd_t set_simd(simd_t level);
+
+/*
+	kernels
+	all buffers may be identical (in place processing), but must not
+	overlap otherwise
+*/
+
+//! dst[i] = src[i] * gain
+void gain(const float* src, float* dst, float gain, std::size_t n);
+//! dst[i] = src[i] * (start + step * i)
+void gain_ramp(const float* src, float* dst, float start, float step,
+	std::size_t n);
+//! dst[i] += src[i]
+void mix(const float* src, float* dst, std::size_t n);
+//! dst[i] += src[i] * gain
+void mix_gain(const float* src, float* dst, float gain, std::size_t n);
+//! pan a mono signal with constant power
+//! @param pan position between -1 (left) and 1 (right)
+void pan(const float* src, float* left, float* right, float pan,
+	std::size_t n);
+//! dst[i] = src[i]
+void copy(const float* src, float* dst, std::size_t n);
+//! dst[i] = 0
+void clear(float* dst, std::size_t n);
+//! return the maximum absolute value
+float peak(const float* src, std::size_t n);
+//! return the root mean square
+float rms(const float* src, std::size_t n);
+//! interleave @p n frames of @p channels planar buffers into @p dst
+void interleave(const float* const* src, float* dst, unsigned channels,
+	std::size_t n);
+//! deinterleave @p n frames of @p src into @p channels planar buffers
+void deinterleave(const float* src, float* const* dst, unsigned channels,
+	std::size_t n);
+
+/*
+	sample format conversion
+*/
+
+//! dithering when converting to integer samples
+enum class dither_t
+{
+	none,        //!< just round (ties to even)
+	rectangular, //!< add white noise of 1 LSB
+	triangular   //!< add triangular (TPDF) noise of 2 LSB
+};
+
+//! state of the dither noise generator
+//! use one per channel, and keep it between the blocks
+struct dither_state
+{
+	uint32_t seed = 1;
+};
+
+void convert(const float* src, double* dst, std::size_t n);
+void convert(const double* src, float* dst, std::size_t n);
+
+void convert(const int16_t* src, float* dst, std::size_t n);
+void convert(const int24_t* src, float* dst, std::size_t n);
+void convert(const int32_t* src, float* dst, std::size_t n);
+
+//! convert to integers, clipping to their range
+//! @param state required unless @p dither is dither_t::none
+void convert(const float* src, int16_t* dst, std::size_t n,
+	dither_t dither = dither_t::none, dither_state* state = nullptr);
+void convert(const float* src, int24_t* dst, std::size_t n,
+	dither_t dither = dither_t::none, dither_state* state = nullptr);
+void convert(const float* src, int32_t* dst, std::size_t n);
+
+} // namespace audio
+} // namespace spa
+
+#endif // SPA_AUDIO_DSP_H
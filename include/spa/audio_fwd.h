@@ -27,23 +27,49 @@ namespace audio {
 
 class invalid_args_error;
 
+class buffer_contract;
+class aligned_buffer;
+enum class signal_t;
+class signal_info;
+
 namespace stereo {
 	class in;
 	class out;
 }
 
+namespace bus {
+	enum class layout_t;
+	class in;
+	class out;
+}
+
 class in;
 class out;
+struct int24_t;
+template<class T> class sample_in;
+template<class T> class sample_out;
 enum class scale_type_t;
 
 template<class T> class control_in;
+template<class T> class atomic_control_in;
+template<class T> struct control_segment;
+template<class T> class automatable_in;
 template<class T> class control_out;
+enum class smoothing_t;
+template<class T> class smoother;
+class param_block;
+class param_block_in;
 class samplerate;
 class buffersize;
 class samplecount;
+class tail_length;
+class decayed;
+class latency;
 
 class osc_ringbuffer;
 class osc_ringbuffer_in;
+struct osc_lane_t;
+class osc_lanes_in;
 class osc_ringbuffer_out;
 
 class visitor;
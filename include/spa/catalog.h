@@ -0,0 +1,99 @@
+/*************************************************************************/
+/* spa - simple plugin API                                               */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file catalog.h
+	lookup of installed plugins by their ID, for hosts
+*/
+
+#ifndef SPA_CATALOG_H
+#define SPA_CATALOG_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "scan_cache.h"
+
+namespace spa {
+namespace host {
+
+//! Maps plugin IDs (see spa::plugin_id()) to the library and the
+//! descriptor index of each plugin
+//!
+//! This lets hosts restore sessions by the IDs stored in the savefile,
+//! without building and hashing unique names for each instance. The
+//! map uses open addressing with linear probing in one flat array, so
+//! lookups do not allocate and usually touch one cache line.
+class catalog
+{
+public:
+	//! where a plugin can be loaded from
+	struct entry
+	{
+		std::uint64_t id;
+		std::uint32_t library; //!< index into libraries()
+		std::uint32_t index; //!< index for the descriptor loader
+	};
+
+	//! @param capacity number of plugins to reserve space for
+	explicit catalog(std::size_t capacity = 0);
+
+	//! add all plugins of a scanned library
+	//! If multiple libraries contain the same plugin, the last one
+	//! added wins.
+	void add(const library_info& info);
+
+	//! add or replace a single plugin
+	//! @param library index into libraries()
+	//! @return true if @p id was not in the catalog yet
+	bool insert(std::uint64_t id, std::uint32_t library,
+		std::uint32_t index);
+	//! @return the plugin with @p id, or nullptr if there is none
+	const entry* find(std::uint64_t id) const;
+	//! @return true if @p id was in the catalog
+	bool erase(std::uint64_t id);
+
+	void reserve(std::size_t capacity);
+	void clear();
+
+	//! number of plugins
+	std::size_t size() const { return count; }
+	//! paths of the libraries added with add()
+	const std::vector<std::string>& libraries() const { return paths; }
+	const std::string& library(const entry& e) const {
+		return paths[e.library]; }
+
+private:
+	//! marks slots without entry
+	static constexpr std::uint32_t empty = UINT32_MAX;
+
+	std::size_t slot(std::uint64_t id) const;
+	void rehash(std::size_t slot_count);
+
+	std::vector<entry> slots; //!< size is 0 or a power of 2
+	std::size_t count = 0;
+	std::vector<std::string> paths;
+};
+
+} // namespace host
+} // namespace spa
+
+#endif // SPA_CATALOG_H
+
@@ -0,0 +1,231 @@
+/*************************************************************************/
+/* spa - simple plugin API                                               */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file graph.h
+	processing graph of multiple plugins, for hosts
+*/
+
+#ifndef SPA_GRAPH_H
+#define SPA_GRAPH_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "audio.h"
+
+namespace spa {
+namespace host {
+
+class scheduler;
+
+//! A directed acyclic graph of plugin instances, connected through their
+//! audio and OSC ports
+//!
+//! Changing the graph (add(), connect(), ...) is not realtime safe and
+//! must not happen concurrently to process(). After changes, compile()
+//! computes the schedule and the buffers once. process() then only runs
+//! the schedule, without allocations, locks or visitors.
+class graph
+{
+public:
+	using node_id = unsigned;
+
+	//! @param buffersize maximum number of samples per process() call
+	explicit graph(unsigned buffersize, long samplerate = 48000);
+	~graph();
+	graph(const graph& ) = delete;
+	graph& operator=(const graph& ) = delete;
+
+	/*
+		building the graph
+	*/
+
+	//! instantiate @p desc, connect its non-audio ports, init and
+	//! activate it. The descriptor must outlive the node.
+	//! @throw spa::exception if a port can not be connected, e.g. an
+	//!   interleaved audio bus, a param block, OSC lanes, a blob return
+	//!   port or audio samples that are not float
+	node_id add(const spa::descriptor& desc);
+	//! deactivate and delete a node, and remove all of its connections
+	void remove(node_id node);
+
+	//! connect output port @p out of @p src to input port @p in of
+	//! @p dst. Both must be audio ports with the same number of
+	//! channels, or an osc_ringbuffer_out and an osc_ringbuffer_in.
+	//! Multiple audio outputs connected to one input are summed up, but
+	//! each OSC port can only have one connection.
+	void connect(node_id src, const char* out, node_id dst, const char* in);
+	void disconnect(node_id src, const char* out,
+		node_id dst, const char* in);
+
+	//! set control port @p port of @p node, of any arithmetic type,
+	//! converting @p value with static_cast
+	//! @note atomic controls can be set at any time, others only while
+	//!   process() is not running
+	void set_control(node_id node, const char* port, double value);
+
+	//! ringbuffer to send OSC messages to input @p port of @p node,
+	//! which must not be connected to another node. Only write to it
+	//! while process() is not running.
+	spa::audio::osc_ringbuffer& osc(node_id node, const char* port);
+	//! switch input @p port of @p node to a new ringbuffer of @p size
+	//! bytes, keeping the messages that were not read yet, e.g. if the
+	//! host must send more at once than fits. Only call it while
+	//! process() is not running. The old ringbuffer is deleted.
+	//! @return the new ringbuffer
+	spa::audio::osc_ringbuffer& resize_osc(node_id node, const char* port,
+		std::size_t size);
+
+	//! latency that @p node currently reports
+	unsigned latency(node_id node) const;
+	//! number of channels of audio port @p port of @p node
+	unsigned channels(node_id node, const char* port) const;
+
+	//! run independent branches of the graph in parallel, using
+	//! @p workers threads in addition to the one calling process(),
+	//! or none to process everything in the calling thread
+	//! The workers are started now, see scheduler for their priority.
+	//! The graph must be compiled again afterwards.
+	void set_workers(unsigned workers);
+
+	//! compute the schedule and assign the buffers
+	//! Buffers are reused as soon as all plugins reading them are done,
+	//! and outputs of plugins that can process in place use the buffers
+	//! of their inputs if possible.
+	//! @throw spa::exception if the graph contains a cycle
+	void compile();
+
+	/*
+		using the compiled graph
+	*/
+
+	//! buffer of channel @p channel of an input port that is not
+	//! connected to any output. The host must fill it before process().
+	//! Valid until the next compile().
+	float* input(node_id node, const char* port, unsigned channel);
+	//! tell the plugin what the host has filled into the buffers of
+	//! input port @p port, e.g. silence, so plugins can be skipped
+	//! The signal is kept until it is set again, or until the next
+	//! compile(), which resets it to signal_t::normal.
+	void set_input_signal(node_id node, const char* port,
+		spa::audio::signal_t signal, float constant_value = 0.0f);
+	//! buffer of channel @p channel of an output port that is not
+	//! connected to any input, containing the result after process().
+	//! Valid until the next compile().
+	const float* output(node_id node, const char* port,
+		unsigned channel) const;
+
+	//! run all plugins in schedule order for @p frames samples
+	//! (at most the buffersize), skipping plugins whose outputs are
+	//! known to be silent. Each plugin runs as soon as its inputs are
+	//! ready, on any of the workers.
+	void process(unsigned frames);
+	//! deactivate and activate all plugins, so the next process()
+	//! starts a new, independent stream, like after add()
+	//! Not realtime safe, unless the plugins' (de)activation is.
+	void reset();
+
+	//! number of plugins in the schedule that process() has skipped
+	unsigned long skipped() const { return skip_count.load(); }
+	unsigned buffersize() const { return max_frames; }
+	//! number of audio buffers that the compiled graph uses
+	std::size_t buffer_count() const { return buffers.size(); }
+
+private:
+	struct node;
+	struct audio_port;
+	struct osc_port;
+	struct visitor;
+
+	//! one plugin in the schedule, referencing ranges of the
+	//! flat arrays below
+	struct step
+	{
+		node* n;
+		unsigned mix_begin, mix_end;
+		unsigned sig_begin, sig_end;
+		unsigned out_begin, out_end;
+		unsigned buf_begin, buf_end;
+		unsigned osc_begin, osc_end;
+	};
+	//! sum up buffers mix_srcs[src_begin, src_end) into dst
+	struct mix_op
+	{
+		float* dst;
+		unsigned src_begin, src_end;
+	};
+	//! compute an input's signal_info from the outputs
+	//! sig_srcs[src_begin, src_end) that are connected to it
+	struct signal_op
+	{
+		spa::audio::signal_info* dst;
+		unsigned src_begin, src_end;
+	};
+	//! OSC ringbuffer that must be reset when its reader is done
+	struct osc_reset
+	{
+		spa::audio::osc_ringbuffer* rb;
+		spa::audio::osc_ringbuffer_in* reader; //!< nullptr if none
+	};
+	struct edge
+	{
+		node_id src, dst;
+		unsigned src_port, dst_port;
+		bool osc;
+	};
+
+	node& get(node_id id) const;
+	//! find the port @p name of @p n as index into audio or osc ports
+	void find_port(const node& n, const char* name,
+		unsigned& idx, bool& osc) const;
+	const audio_port& find_audio(node_id node, const char* port) const;
+	void run(const step& s, unsigned frames);
+	static void run_task(void* self, unsigned task);
+
+	unsigned max_frames;
+	long samplerate;
+	//! the samplecount for all plugins
+	unsigned frames = 0;
+	bool compiled = true;
+	std::atomic<unsigned long> skip_count;
+	std::unique_ptr<scheduler> sched;
+
+	std::vector<std::unique_ptr<node>> nodes; //!< nullptr if removed
+	std::vector<edge> edges;
+
+	// compiled graph
+	std::vector<step> schedule;
+	std::vector<mix_op> mixes;
+	std::vector<const float*> mix_srcs;
+	std::vector<signal_op> sigs;
+	std::vector<const spa::audio::signal_info*> sig_srcs;
+	std::vector<spa::audio::signal_info*> outs;
+	std::vector<float*> out_bufs;
+	std::vector<spa::audio::osc_ringbuffer_in*> osc_ins;
+	std::vector<osc_reset> osc_resets;
+	std::vector<std::unique_ptr<spa::audio::aligned_buffer>> buffers;
+};
+
+} // namespace host
+} // namespace spa
+
+#endif // SPA_GRAPH_H
+
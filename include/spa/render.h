@@ -0,0 +1,244 @@
+/*************************************************************************/
+/* spa - simple plugin API                                               */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file render.h
+	offline rendering of audio files through plugins, for hosts
+*/
+
+#ifndef SPA_RENDER_H
+#define SPA_RENDER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "audio_dsp.h"
+#include "spa.h"
+
+namespace spa {
+namespace host {
+
+/*
+	WAV files
+*/
+
+//! reads interleaved samples from 16, 24 or 32 bit integer or 32 or 64
+//! bit float WAV files, converting them to float
+class wav_reader
+{
+public:
+	//! @throw spa::exception if the file can not be read
+	explicit wav_reader(const std::string& path);
+	~wav_reader();
+	wav_reader(const wav_reader& ) = delete;
+	wav_reader& operator=(const wav_reader& ) = delete;
+
+	unsigned channels() const { return chans; }
+	long samplerate() const { return rate; }
+	//! number of frames in the file
+	std::uint64_t frames() const { return total; }
+
+	//! read up to @p frames interleaved frames into @p dst
+	//! @return number of frames read, 0 at the end of the file
+	std::size_t read(float* dst, std::size_t frames);
+
+private:
+	std::FILE* file;
+	unsigned chans = 0, sample_bytes = 0;
+	bool is_float = false;
+	long rate = 0;
+	std::uint64_t total = 0, left = 0;
+	std::vector<char> raw;
+};
+
+//! writes interleaved float samples into WAV files
+class wav_writer
+{
+public:
+	enum class format
+	{
+		float32,
+		int16, //!< with triangular dither
+		int24  //!< with triangular dither
+	};
+
+	//! @throw spa::exception if the file can not be created
+	wav_writer(const std::string& path, unsigned channels,
+		long samplerate, format fmt = format::float32);
+	//! calls close()
+	~wav_writer();
+	wav_writer(const wav_writer& ) = delete;
+	wav_writer& operator=(const wav_writer& ) = delete;
+
+	//! append @p frames interleaved frames from @p src
+	//! @throw spa::exception if that fails, or, without writing
+	//!   anything, if the file would exceed the 4 GiB of WAV files
+	void write(const float* src, std::size_t frames);
+	//! write the sizes into the header and close the file
+	void close();
+
+private:
+	unsigned sample_bytes() const;
+	void header();
+
+	std::FILE* file;
+	unsigned chans;
+	long rate;
+	format fmt;
+	std::uint64_t total = 0;
+	std::vector<char> raw;
+	spa::audio::dither_state dither;
+};
+
+/*
+	rendering
+*/
+
+//! OSC message that is sent to a plugin at a given frame
+struct automation_event
+{
+	std::uint64_t frame;
+	unsigned node; //!< index of the plugin in the chain
+	std::string port; //!< OSC input port of the plugin
+	std::string msg; //!< encoded OSC message
+};
+
+//! Read automation from a text file, with one event per line:
+//! `<frame> <plugin index> <port> <OSC path> <types> <arguments...>`,
+//! e.g. `48000 0 osc /gain f 0.5`. Types can be i, h, f, d, s, T and F,
+//! strings must not contain spaces. Lines starting with # are ignored.
+//! @return the events, sorted by frame
+//! @throw spa::exception if the file can not be read or parsed
+std::vector<automation_event> load_automation(const std::string& path);
+
+struct render_options
+{
+	//! maximum number of frames per process() call
+	unsigned block = 4096;
+	//! number of blocks that the reading and the writing thread may
+	//! work on ahead of processing, 2 means double buffering
+	unsigned queue = 2;
+	//! seconds of silence to render after each input file, converted
+	//! with the samplerate of that file
+	double tail_seconds = 0;
+	//! audio ports that connect the plugins
+	const char* in_port = "in";
+	const char* out_port = "out";
+	wav_writer::format format = wav_writer::format::float32;
+};
+
+struct render_stats
+{
+	std::uint64_t frames = 0; //!< frames written
+	unsigned channels = 0;
+	double seconds = 0; //!< wall clock time
+	//! time that processing waited for reading or writing the files
+	double io_wait = 0;
+};
+
+//! Render the file @p in through the plugins @p chain, connected in
+//! series, into the file @p out, as fast as possible
+//!
+//! The plugins are instantiated on the calling thread, which also runs
+//! them. One thread reads and converts the input and one converts and
+//! writes the output, overlapped with processing. Blocks are split at
+//! automation events, so they are sample accurate. A mono input is fed
+//! into all channels of the first plugin.
+//! @throw spa::exception on I/O errors, if the plugins do not fit, or
+//!   if there is automation after the end of the rendered audio
+render_stats render(const std::vector<const spa::descriptor*>& chain,
+	const std::string& in, const std::string& out,
+	const std::vector<automation_event>& automation = {},
+	const render_options& options = render_options());
+
+/*
+	render farm
+*/
+
+//! one file to render with render_farm()
+struct render_job
+{
+	std::string in, out;
+	render_stats stats; //!< set when the job succeeded
+	std::string error; //!< set when the job failed
+};
+
+struct farm_options
+{
+	//! number of worker threads, 0 means one per CPU
+	unsigned workers = 0;
+	//! pin each worker's processing thread to one of the CPUs that
+	//! this process may use
+	bool pin = true;
+};
+
+struct farm_stats
+{
+	std::uint64_t frames = 0; //!< frames written by all jobs
+	std::uint64_t samples = 0; //!< frames times channels
+	unsigned workers = 0;
+	std::size_t failed = 0; //!< number of jobs with errors
+	double seconds = 0; //!< wall clock time
+
+	double samples_per_second() const {
+		return seconds > 0 ? samples / seconds : 0; }
+};
+
+//! Render many files through the same chain, in parallel
+//!
+//! Each worker thread instantiates its own plugins from the shared
+//! descriptors, and renders one job after another with them, like
+//! render(). Between two files, the plugins are deactivated and
+//! activated again, and they are only instantiated again if the
+//! samplerate changes or a job failed. A pinned worker instantiates
+//! them after pinning, so their memory is allocated near its CPU. The
+//! reading and writing threads of its jobs are not pinned.
+//! A job that fails does not stop the others, see render_job::error.
+//! @param jobs the files, results are written back into it
+farm_stats render_farm(const std::vector<const spa::descriptor*>& chain,
+	std::vector<render_job>& jobs,
+	const std::vector<automation_event>& automation = {},
+	const render_options& options = render_options(),
+	const farm_options& farm = farm_options());
+
+//! a descriptor from a library, which stays loaded while this exists
+class plugin_library
+{
+public:
+	//! load the plugin number @p index from the library at @p path
+	//! @throw spa::exception if that fails
+	plugin_library(const std::string& path, unsigned long index = 0);
+	~plugin_library();
+	plugin_library(const plugin_library& ) = delete;
+	plugin_library& operator=(const plugin_library& ) = delete;
+
+	const spa::descriptor& descriptor() const { return *desc; }
+
+private:
+	void* lib;
+	spa::descriptor* desc = nullptr;
+};
+
+} // namespace host
+} // namespace spa
+
+#endif // SPA_RENDER_H
+
@@ -0,0 +1,143 @@
+/*************************************************************************/
+/* spa - simple plugin API                                               */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file scan_cache.h
+	persistent index of the plugins in libraries, for hosts
+*/
+
+#ifndef SPA_SCAN_CACHE_H
+#define SPA_SCAN_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "spa.h"
+
+namespace spa {
+namespace host {
+
+//! metadata of one descriptor, which a host can show without loading
+//! the library
+struct plugin_info
+{
+	//! index to pass to the library's descriptor loader
+	unsigned long index = 0;
+	std::uint64_t id = 0; //!< see spa::plugin_id()
+	std::string unique_name; //!< see spa::unique_name()
+	std::string name;
+	std::vector<std::string> port_names;
+	spa::descriptor::license_type license =
+		spa::descriptor::license_type::gpl_3_0;
+	struct spa::descriptor::properties properties = {};
+};
+
+//! result of scanning one library
+struct library_info
+{
+	std::string path;
+	//! size and modification time (ns since the epoch) of the file
+	//! when it was scanned
+	std::uint64_t size = 0;
+	std::int64_t mtime = 0;
+	//! why the library could not be scanned, empty if at least one of
+	//! its plugins could be loaded (broken ones are left out)
+	std::string error;
+	std::vector<plugin_info> plugins;
+};
+
+//! get the size and modification time of @p path, which identify the
+//! version of a library that a library_info belongs to
+//! @return false if the file can not be accessed
+bool stat_file(const std::string& path, std::uint64_t& size,
+	std::int64_t& mtime);
+
+//! load the library @p path in this process and read the metadata of
+//! all of its descriptors
+//! @note a crashing library crashes the calling process, see
+//!   scanner.h to avoid this
+library_info scan_library(const std::string& path);
+
+//! append @p info to @p buf, in the binary format of the index
+void serialize(const library_info& info, std::string& buf);
+//! read a library_info that serialize() wrote from [@p cur, @p end)
+//! and advance @p cur behind it
+//! @return false if the data is truncated or corrupt
+bool deserialize(const char*& cur, const char* end, library_info& info);
+
+//! On-disk index of scanned libraries, keyed by path, size and mtime
+//!
+//! Loading the index only reads one file. Libraries are checked (using
+//! stat) when they are looked up, and only loaded if they are new or
+//! have changed since they have been scanned. Libraries that failed to
+//! load are remembered as well, so broken libraries are not loaded at
+//! each start again.
+class scan_cache
+{
+public:
+	//! function that scans one library, see scan_library()
+	using scan_fn = library_info (*)(const std::string& path);
+
+	//! read the index from @p file, if it exists
+	//! A corrupt or outdated file is ignored, since all of its
+	//! contents can be scanned again.
+	explicit scan_cache(std::string file, scan_fn scan = &scan_library);
+
+	//! metadata of the library at @p path, scanning it if required
+	//! @note the host should pass absolute paths
+	//! @throw spa::exception if @p path does not exist
+	const library_info& lookup(const std::string& path);
+
+	//! paths out of @p paths that lookup() would need to scan, so the
+	//! host can scan them in advance (e.g. in parallel) and insert()
+	//! the results
+	std::vector<std::string> stale(const std::vector<std::string>& paths);
+	//! add or replace the result of a scan
+	void insert(library_info info);
+	//! remove all libraries that do not exist anymore
+	void prune();
+
+	//! write the index back if anything changed
+	//! The file is replaced atomically, so concurrent hosts never
+	//! read a partially written index.
+	//! @throw spa::exception if the file can not be written
+	void save();
+
+	std::size_t size() const { return libs.size(); }
+	bool changed() const { return dirty; }
+
+private:
+	//! whether @p info is up to date with the file at its path
+	//! @param exists set to whether the file exists
+	static bool current(const library_info& info, bool& exists);
+	void load();
+
+	std::string file;
+	scan_fn scan;
+	std::unordered_map<std::string, library_info> libs;
+	bool dirty = false;
+};
+
+} // namespace host
+} // namespace spa
+
+#endif // SPA_SCAN_CACHE_H
+
@@ -0,0 +1,71 @@
+/*************************************************************************/
+/* spa - simple plugin API                                               */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file scanner.h
+	scanning plugin libraries in separate processes, for hosts
+*/
+
+#ifndef SPA_SCANNER_H
+#define SPA_SCANNER_H
+
+#include <string>
+#include <vector>
+
+#include "scan_cache.h"
+
+namespace spa {
+namespace host {
+
+//! Scans libraries in a pool of forked worker processes
+//!
+//! Each worker loads one library after another, using scan_library(),
+//! and sends back the metadata through a socket. If a library crashes
+//! its worker or does not finish in time, the worker is killed and
+//! replaced, and the library's error tells what happened. This way,
+//! broken libraries can not take the host down, and all cores are used.
+//!
+//! The results can be stored in a scan_cache using scan_cache::insert().
+class scanner
+{
+public:
+	//! @param jobs maximum number of worker processes, or 0 for one
+	//!   per CPU core
+	//! @param timeout_ms time that one library may take to be scanned
+	explicit scanner(unsigned jobs = 0, unsigned timeout_ms = 10000);
+
+	//! scan all of @p paths
+	//! @return one result for each path, in the same order
+	//! @note the workers are forked from the calling thread, so other
+	//!   threads of the host should not hold locks that the scan needs
+	//!   (e.g. the dynamic linker's)
+	std::vector<library_info> scan(const std::vector<std::string>& paths);
+
+	unsigned jobs() const { return max_jobs; }
+
+private:
+	unsigned max_jobs;
+	unsigned timeout_ms;
+};
+
+} // namespace host
+} // namespace spa
+
+#endif // SPA_SCANNER_H
+
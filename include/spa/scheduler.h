@@ -0,0 +1,123 @@
+/*************************************************************************/
+/* spa - simple plugin API                                               */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+/**
+	@file scheduler.h
+	parallel execution of task graphs, for hosts
+*/
+
+#ifndef SPA_SCHEDULER_H
+#define SPA_SCHEDULER_H
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace spa {
+namespace host {
+
+//! Runs a fixed directed acyclic graph of tasks (e.g. plugins) on a pool
+//! of worker threads, releasing each task as soon as all of its
+//! predecessors are done
+//!
+//! Each thread has a work stealing deque: it runs the tasks that it has
+//! released itself first, and steals from the others when it is idle.
+//! Idle workers spin for a while before they sleep until the next run().
+//! There should not be more workers than free CPU cores.
+//! run() is lock free and does not allocate.
+class scheduler
+{
+public:
+	//! task function, called with the context passed to run()
+	using task_fn = void (*)(void* ctx, unsigned task);
+
+	//! start @p workers threads, which help the thread calling run()
+	//! The workers use the scheduling policy and priority of the
+	//! calling thread, so create the scheduler from the audio thread
+	//! or give the calling thread realtime priority before.
+	explicit scheduler(unsigned workers);
+	~scheduler();
+	scheduler(const scheduler& ) = delete;
+	scheduler& operator=(const scheduler& ) = delete;
+
+	//! set up the task graph, not realtime safe
+	//! @param successors for each task, the tasks that depend on it
+	//!   (a task may appear multiple times, counting as multiple
+	//!   dependencies)
+	void prepare(const std::vector<std::vector<unsigned>>& successors);
+
+	//! run all tasks once, calling @p fn concurrently from the calling
+	//! thread and the workers, and return when all are done
+	void run(task_fn fn, void* ctx);
+
+	//! number of worker threads, excluding the thread calling run()
+	unsigned workers() const { return threads.size(); }
+
+private:
+	//! Chase-Lev deque of task indices with fixed capacity
+	class deque
+	{
+		std::atomic<long> top, bottom;
+		std::unique_ptr<std::atomic<unsigned>[]> items;
+		long mask = 0;
+	public:
+		deque() : top(0), bottom(0) {}
+		void resize(std::size_t capacity);
+		//! owner only: push at the bottom
+		void push(unsigned task);
+		//! owner only: pop from the bottom
+		bool pop(unsigned& task);
+		//! any thread: steal from the top
+		bool steal(unsigned& task);
+	};
+
+	void work(unsigned self);
+	void execute(unsigned self, unsigned task);
+	void worker_main(unsigned self);
+
+	// task graph
+	unsigned task_count = 0;
+	std::vector<unsigned> deps;
+	std::vector<unsigned> succ_begin;
+	std::vector<unsigned> succ;
+	std::unique_ptr<std::atomic<unsigned>[]> pending;
+
+	// current run
+	task_fn fn = nullptr;
+	void* ctx = nullptr;
+	std::atomic<unsigned> remaining;
+
+	// pool
+	//! one deque for each worker, and the last for the calling thread
+	std::unique_ptr<deque[]> deques;
+	std::vector<std::thread> threads;
+	//! incremented for each run(), workers sleep on it
+	std::atomic<int> epoch;
+	std::atomic<unsigned> parked;
+	//! number of workers that may access the task graph
+	std::atomic<unsigned> busy;
+	std::atomic<bool> stop;
+};
+
+} // namespace host
+} // namespace spa
+
+#endif // SPA_SCHEDULER_H
+
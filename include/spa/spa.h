@@ -44,6 +44,10 @@
 
 #include <string> // used for host functions only (see bottom of file)
 #include <cassert>
+#include <cstdint>
+// std::atomic<T> has the layout of T for all integral T on all supported
+// platforms, so it can be shared between plugin and host
+#include <atomic>
 
 // fix "major" defined in GNU libraries
 #ifdef major
@@ -97,9 +101,10 @@ inline bool operator>=(const version_t& lhs, const version_t& rhs) {
 }
 
 //! current version of this spa API
-constexpr const version_t api_version(0, 0, 3);
+constexpr const version_t api_version(0, 1, 0);
 //! least spa API version that is compatible
-constexpr const version_t least_api_version(0, 0, 2);
+//! 0.1.0 changed the descriptor's virtual functions and the visitors
+constexpr const version_t least_api_version(0, 1, 0);
 
 namespace detail {
 
@@ -121,6 +126,23 @@ inline bool m_streq(const char* s1, const char* s2)
 	return *s1 == *s2;
 }
 
+constexpr std::uint64_t fnv_offset = 14695981039346656037ull;
+constexpr std::uint64_t fnv_prime = 1099511628211ull;
+
+//! 64 bit FNV-1a hash of @p str, continuing from @p hash
+constexpr std::uint64_t fnv1a(const char* str,
+	std::uint64_t hash = fnv_offset)
+{
+	return *str ? fnv1a(str + 1,
+		(hash ^ static_cast<unsigned char>(*str)) * fnv_prime) : hash;
+}
+
+//! hash of @p field and the separator, continuing from @p hash
+constexpr std::uint64_t fnv1a_field(const char* field, std::uint64_t hash)
+{
+	return fnv1a("::", fnv1a(field, hash));
+}
+
 }
 
 //! base class for all exceptions that the API introduces
@@ -186,6 +208,23 @@ public:
 				 api_version, plugin_expects) {}
 };
 
+//! Stable 64 bit ID of a plugin, computed from its identification
+//! (see descriptor::hoster() to descriptor::label())
+//! The ID is the 64 bit FNV-1a hash of unique_name() with the default
+//! separator, so it can be computed at compile time. See the README for
+//! the specification, which must never change, since hosts store IDs.
+//! @param organization may be nullptr, like descriptor::organization_url()
+constexpr std::uint64_t plugin_id(const char* hoster,
+	const char* organization, const char* project, const char* branch,
+	const char* label)
+{
+	return detail::fnv1a(label, detail::fnv1a_field(branch,
+		detail::fnv1a_field(project, organization
+			? detail::fnv1a_field(organization,
+				detail::fnv1a_field(hoster, detail::fnv_offset))
+			: detail::fnv1a_field(hoster, detail::fnv_offset))));
+}
+
 //! name of the entry function that a host must resolve
 constexpr const char* descriptor_name = "spa_descriptor";
 
@@ -259,6 +298,14 @@ public:
 	}
 	//! Construct an empty vector. Guaranteed not to alloc
 	simple_vec() noexcept(false) {}
+	//! Construct a vector of @p size default constructed elements
+	static simple_vec with_size(unsigned size) noexcept(false)
+	{
+		simple_vec res;
+		res.len = size;
+		res._data = new T[size];
+		return res;
+	}
 	template<class ...Args>
 	simple_vec(const Args& ...args) {
 		len = sizeof...(args);
@@ -349,7 +396,7 @@ public:
 #define SPA_OBJECT void accept(class spa::visitor& v) override;
 
 //! class for simple types
-//! TODO: use atomics
+//! @note reading and writing is not thread safe, see atomic_port_ref
 template<class T>
 class port_ref : public virtual port_ref_base
 {
@@ -374,6 +421,29 @@ public:
 //	void set_ref(const T* pointer) { ref = pointer; }
 };
 
+//! class for simple types that another thread (e.g. the host's UI thread)
+//! can write while the plugin reads them in run(), without locks
+//! The host owns the atomic variable. Loads are relaxed (i.e. as cheap as
+//! plain loads), stores from the host are release stores.
+//! @note T should be lock free, e.g. bool, int or float
+template<class T>
+class atomic_port_ref : public virtual port_ref_base
+{
+	std::atomic<T>* ref;
+public:
+	SPA_OBJECT
+
+	operator T() const { return get(); }
+	T get() const { return ref->load(std::memory_order_relaxed); }
+
+	const atomic_port_ref<T>& operator=(const T& value) {
+		return set(value); }
+	const atomic_port_ref<T>& set(const T& value) {
+		ref->store(value, std::memory_order_release); return *this; }
+
+	void set_ref(std::atomic<T>* pointer) { ref = pointer; }
+};
+
 class counted : public virtual port_ref_base {
 public:
 	int channel;
@@ -409,6 +479,7 @@ class ringbuffer_base
 	std::size_t size, pos;
 public:
 	std::size_t write_space() const { return size - pos; }
+	std::size_t get_size() const { return size; }
 	void write(const T* data, std::size_t n) {
 		for(std::size_t i = 0; i < n; ++i)
 			buffer[pos++] = data[i];
@@ -435,7 +506,10 @@ class ringbuffer<char> : public ringbuffer_base<char>
 {
 	using base = ringbuffer_base<char>;
 public:
-	void write_with_length(const char* data, std::size_t len)
+	//! write @p len bytes of @p data, prepended by their length
+	//! @return false iff there was not enough space (nothing is written
+	//!   then, so the host could switch to a larger ringbuffer and retry)
+	bool write_with_length(const char* data, std::size_t len)
 	{
 		if(write_space() >= len + 4)
 		{
@@ -450,7 +524,10 @@ public:
 			//	+lenc[0], +lenc[1], +lenc[2], +lenc[3]);
 			base::write(lenc, 4);
 			base::write(data, len);
+			return true;
 		}
+		else
+			return false;
 	}
 
 	ringbuffer(std::size_t size) : base(size) {}
@@ -486,12 +563,17 @@ public:
 	std::size_t read_space() const { return ref->pos - pos; }
 
 	read_sequence_t read(std::size_t n) {
-		assert(n <= read_space());
-		read_sequence_t res { ref->buffer, pos, n };
+		read_sequence_t res = peek(n);
 		pos += n;
 		return res;
 	}
 
+	//! like read(), but does not advance the read position
+	read_sequence_t peek(std::size_t n) const {
+		assert(n <= read_space());
+		return read_sequence_t { ref->buffer, pos, n };
+	}
+
 	ringbuffer_in_base(std::size_t s) : size(s), pos(0) {}
 
 	void connect(ringbuffer_base<T>& _ref)
@@ -502,6 +584,24 @@ public:
 		 ref = &_ref;
 	}
 
+	//! Switch over to another (usually larger) host ringbuffer, moving
+	//! all data that has not been read yet to its beginning
+	//! The host must call this at a safe point, i.e. while the plugin's
+	//! run() is not executing, and must only write to @p other
+	//! afterwards (the old ringbuffer can then be deleted)
+	void switch_to(ringbuffer_base<T>& other)
+	{
+		std::size_t pending = read_space();
+		if(other.size < pending)
+		 throw out_of_range(pending, other.size);
+		for(std::size_t i = 0; i < pending; ++i)
+		 other.buffer[i] = ref->buffer[pos + i];
+		other.pos = pending;
+		size = other.size;
+		ref = &other;
+		pos = 0;
+	}
+
 	std::size_t get_size() const { return size; }
 
 	void reset() { pos = 0; }
@@ -520,10 +620,31 @@ template<>
 class base_ringbuffer_in<char> : public ringbuffer_in_base<char>
 {
 	uint32_t length = 0, lastlength = 0; // length of the next string
+
+	//! decode the big endian length that write_with_length() prepends
+	static uint32_t decode_length(const read_sequence_t& rd)
+	{
+		return static_cast<uint32_t>(static_cast<unsigned char>(rd[3]))
+		 + (static_cast<uint32_t>(static_cast<unsigned char>(rd[2])) << 8)
+		 + (static_cast<uint32_t>(static_cast<unsigned char>(rd[1])) << 16)
+		 + (static_cast<uint32_t>(static_cast<unsigned char>(rd[0])) << 24);
+	}
 public:
 	using base = ringbuffer_in_base<char>;
 	using base::ringbuffer_in_base;
 
+	//! return the length of the next message without reading it,
+	//! or 0 if there is no next message
+	std::size_t next_msg_length() const
+	{
+		if(length)
+			return length;
+		else if(read_space() < 4)
+			return 0;
+		else
+			return decode_length(peek(4));
+	}
+
 	//! read the next message into temporary buffer
 	//! @return true iff there was a next message;
 	bool read_msg(char* read_buffer, std::size_t max)
@@ -533,17 +654,8 @@ public:
 			if(!length) {
 				uint32_t clength;
 				{
-					auto rd = read(4);
-					clength = static_cast<uint32_t>(+rd[3])
-					 + static_cast<uint32_t>(+rd[2] << 8)
-					 + static_cast<uint32_t>(+rd[1] << 16)
-					 + static_cast<uint32_t>(+rd[0] << 24);
-					if(clength > 256)
-					    printf("read length array: %x%x%x%x\n",
-					    +rd[0], +rd[1], +rd[2], +rd[3]);
+					clength = decode_length(read(4));
 				}
-				//assert(clength < 256); // TODO: remove me
-				//printf("read length: %d\n", +clength);
 				std::size_t rs = read_space();
 				// if anything, then at least the matching message
 				assert(rs == 0 || rs >= clength);
@@ -601,6 +713,95 @@ public:
 	ringbuffer<T>* ref;
 };
 
+/*
+ * shared blobs
+ */
+
+//! Reference counted buffer that the host shares with plugins without
+//! copying it, e.g. for samples or wavetables.
+//! The host allocates the blob and only sends its handle() to the plugin,
+//! e.g. as OSC argument of type 'h'. The plugin gets a reference that it
+//! must give back using a blob_return_out port. Only the host may free
+//! the blob, so plugins never free memory on the audio thread.
+class shared_blob
+{
+	std::atomic<unsigned> refs;
+	std::size_t _size;
+	char* _data;
+public:
+	//! Return the blob's data
+	const char* data() const noexcept { return _data; }
+	//! Return the blob's data
+	char* data() noexcept { return _data; }
+	//! Return the number of bytes
+	std::size_t size() const noexcept { return _size; }
+
+	//! Return a handle that can be passed to a plugin via OSC
+	int64_t handle() const noexcept {
+		return static_cast<int64_t>(reinterpret_cast<intptr_t>(this)); }
+	//! Return the blob that @p handle() has been called on
+	static shared_blob* from_handle(int64_t handle) noexcept {
+		return reinterpret_cast<shared_blob*>(
+			static_cast<intptr_t>(handle)); }
+
+	/*
+	 * host functions only
+	 */
+	//! Add a reference, i.e. one for each plugin the handle is sent to
+	void ref() noexcept { refs.fetch_add(1, std::memory_order_relaxed); }
+	//! Remove a reference and free the blob if it was the last one
+	void release() noexcept
+	{
+		if(refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			delete this;
+	}
+
+	//! Create a blob of @p size bytes, with one reference for the host
+	shared_blob(std::size_t size) :
+		refs(1), _size(size), _data(new char[size]) {}
+	shared_blob(const shared_blob& other) = delete;
+private:
+	~shared_blob() { delete[] _data; }
+};
+
+//! port for plugins to give blobs back to the host
+class blob_return_out : public ringbuffer_out<shared_blob*>
+{
+public:
+	SPA_OBJECT
+	//! Give the reference to @p blob back to the host
+	//! @return false if the ringbuffer is full. In this case, the plugin
+	//!   should keep the blob and try again in the next block.
+	bool give_back(shared_blob* blob)
+	{
+		if(!ref->write_space())
+			return false;
+		ref->write(&blob, 1);
+		return true;
+	}
+};
+
+//! ringbuffer instance for the host that receives blobs from a plugin
+class blob_return_ringbuffer : public ringbuffer<shared_blob*>
+{
+	ringbuffer_in_base<shared_blob*> reader;
+public:
+	//! Release all blobs that the plugin has given back
+	//! Must not be called while the plugin's run() is executing
+	void collect()
+	{
+		while(reader.read_space())
+			reader.read(1)[0]->release();
+		reset();
+		reader.reset();
+	}
+
+	blob_return_ringbuffer(std::size_t size) :
+		ringbuffer<shared_blob*>(size), reader(size) {
+		reader.connect(*this); }
+	~blob_return_ringbuffer() { collect(); }
+};
+
 //! make a visitor function for type @p type, which will default to
 //! visiting a base class @p base of it
 #define SPA_MK_VISIT(type, base) \
@@ -614,6 +815,7 @@ public:
 #define SPA_MK_VISIT_PR(type) \
 	SPA_MK_VISIT(port_ref<type>, port_ref_base) \
 	SPA_MK_VISIT(port_ref<const type>, port_ref_base) \
+	SPA_MK_VISIT(atomic_port_ref<type>, port_ref_base) \
 	SPA_MK_VISIT(ringbuffer_in<type>, port_ref_base)
 
 #define SPA_MK_VISIT_PR2(type) SPA_MK_VISIT_PR(type) \
@@ -633,6 +835,8 @@ public:
 #undef SPA_MK_VISIT_PR2
 #undef SPA_MK_VISIT_PR
 
+	SPA_MK_VISIT(blob_return_out, port_ref_base)
+
 	virtual ~visitor();
 };
 
@@ -650,7 +854,9 @@ public:
 	}
 
 ACCEPT_T(port_ref, spa::visitor)
+ACCEPT_T(atomic_port_ref, spa::visitor)
 ACCEPT_T(ringbuffer_in, spa::visitor)
+ACCEPT_T(ringbuffer_out, spa::visitor)
 
 //! Base class for the spa plugin
 class plugin
@@ -860,11 +1066,13 @@ public:
 	//! Function that should clean up the memory of this descriptor
 	virtual void delete_self() { delete this; } */
 
-	//! Return all port names the plugin wants to expose. Must be
-	//! nullptr-terminated.
+	//! Return all port names the plugin wants to expose
 	//! There can still be other ports. The host can find them using
 	//! dnd, or if they are in an old-versioned savefile.
-	virtual simple_vec<simple_str> port_names() const = 0;
+	//! The default implementation copies port_name_table().
+	//! @note plugins must implement this or port_name_table(), hosts
+	//!   should prefer port_name_table() if it is not nullptr
+	virtual simple_vec<simple_str> port_names() const;
 
 	//! csv-list of files that can be loaded, e.g. "xmz, xiz"
 	virtual const char* save_formats() const { return nullptr; }
@@ -880,6 +1088,17 @@ public:
 	virtual int version_minor() const { return 0; }
 	virtual int version_patch() const { return 0; }
 
+	// new virtual functions go here, behind the old ones
+
+	//! Stable ID computed from the identification, see
+	//! spa::plugin_id(). Plugins can return a precomputed constant.
+	virtual std::uint64_t id() const;
+
+	//! Return a static, nullptr-terminated array of all port names the
+	//! plugin wants to expose, which hosts can read without allocating
+	//! @see port_names()
+	virtual const char* const* port_name_table() const { return nullptr; }
+
 	/*
 	 * properties
 	 */
@@ -891,12 +1110,28 @@ public:
 		unsigned realtime_dependency:1;
 		//! plugin makes no syscalls and uses no "slow algorithms"
 		unsigned hard_rt_capable:1;
+		//! plugin can process in place, i.e. the host may connect
+		//! each output buffer to the same buffer as the input
+		//! buffer of the same channel
+		unsigned in_place:1;
+		//! plugin has no tail, i.e. if all input signals are silent
+		//! and it receives no events, all output signals are silent,
+		//! so the host does not need to run it
+		unsigned no_tail:1;
 	} properties;
+
+	//! Constructor, initializes all properties to 0
+	descriptor() : properties() {}
 };
 
 //! Function that must return a spa descriptor.
-//! The argument must currently be 0 (TODO).
 //! Entry point for any plugin.
+//! A library can contain multiple plugins. The host calls this function
+//! with 0, 1, 2, ... and gets one new descriptor for each plugin, until
+//! the function returns nullptr. Each call must only construct the
+//! requested descriptor, so hosts can load single plugins by their
+//! index without constructing all others. The indices of a library must
+//! not change as long as the library file does not change.
 //! @note by default, the descriptor will be freed using delete
 //!   This can be changed by overriding descriptor::delete_self()
 typedef descriptor* (*descriptor_loader_t) (unsigned long);
@@ -912,28 +1147,29 @@ inline void assert_versions_match(const spa::descriptor& descriptor)
 
 // TODO: move to host only file
 
-inline std::string unique_name(const spa::descriptor& desc,
-				const char* sep = "::")
+//! hoster part of unique_name() and plugin_id()
+inline const char* hoster_name(const spa::descriptor& desc)
 {
-	std::string res;
 	switch(desc.hoster())
 	{
 		case spa::descriptor::hoster_t::localhost:
-			res = "github.com";
-			break;
+			return "github.com";
 		case spa::descriptor::hoster_t::github:
-			res = "github.com";
-			break;
+			return "github.com";
 		case spa::descriptor::hoster_t::gitlab:
-			res = "gitlab.com";
-			break;
+			return "gitlab.com";
 		case spa::descriptor::hoster_t::sourceforge:
-			res = "sourcefourge.net";
-			break;
+			return "sourceforge.net";
 		case spa::descriptor::hoster_t::other:
-			res = desc.hoster_other();
 			break;
 	}
+	return desc.hoster_other();
+}
+
+inline std::string unique_name(const spa::descriptor& desc,
+				const char* sep = "::")
+{
+	std::string res = hoster_name(desc);
 	res += sep;
 	if(desc.organization_url()) {
 		res += desc.organization_url();
@@ -32,6 +32,7 @@ namespace spa
 	class port_ref_base;
 
 	template<class T> class port_ref;
+	template<class T> class atomic_port_ref;
 
 	template<class T> class ringbuffer;
 	template<> class ringbuffer<char>;
@@ -40,6 +41,10 @@ namespace spa
 
 	template<class T> class ringbuffer_out;
 
+	class shared_blob;
+	class blob_return_out;
+	class blob_return_ringbuffer;
+
 	class visitor;
 
 	class plugin;
@@ -20,14 +20,25 @@ namespace stereo {
 	ACCEPT_SPA_AUDIO(out)
 }
 
+namespace bus {
+	ACCEPT_SPA_AUDIO(in)
+	ACCEPT_SPA_AUDIO(out)
+}
+
 ACCEPT_SPA_AUDIO(in)
 ACCEPT_SPA_AUDIO(out)
 
+ACCEPT_SPA_AUDIO(param_block_in)
 ACCEPT_SPA_AUDIO(samplerate)
 ACCEPT_SPA_AUDIO(buffersize)
 ACCEPT_SPA_AUDIO(samplecount)
+ACCEPT_SPA_AUDIO(tail_length)
+ACCEPT_SPA_AUDIO(decayed)
+ACCEPT_SPA_AUDIO(latency)
 
 ACCEPT_SPA_AUDIO(osc_ringbuffer_in)
+ACCEPT_SPA_AUDIO(osc_lanes_in)
+ACCEPT_SPA_AUDIO(osc_ringbuffer_out)
 
 #undef ACCEPT_SPA_AUDIO
 
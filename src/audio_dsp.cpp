@@ -0,0 +1,541 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#include <spa/audio.h>
+#include <spa/audio_dsp.h>
+
+namespace spa {
+namespace audio {
+
+//! force inlining of the kernel implementations into the functions
+//! compiled for the different instruction sets
+#define SPA_KERNEL_INLINE __attribute__((always_inline)) inline
+
+/*
+	helpers
+*/
+
+namespace {
+
+//! white noise in [-0.5, 0.5), realtime safe
+inline float noise(dither_state& st)
+{
+	st.seed = st.seed * 1664525u + 1013904223u;
+	return static_cast<float>(st.seed >> 8) * (1.0f / 16777216.0f) - 0.5f;
+}
+
+//! dither noise in LSB
+inline float dither_noise(dither_t dither, dither_state& st)
+{
+	switch(dither)
+	{
+		case dither_t::rectangular: return noise(st);
+		case dither_t::triangular: return noise(st) + noise(st);
+		default: return 0.0f;
+	}
+}
+
+//! adding and subtracting this rounds to the nearest integer (ties to
+//! even) for values below 2^22 (float) or 2^51 (double)
+template<class F> constexpr F round_magic();
+template<> constexpr float round_magic<float>() { return 12582912.0f; }
+template<> constexpr double round_magic<double>() {
+	return 6755399441055744.0; }
+
+//! scale, round and clip @p x to an integer in [min, max], NaN to min
+//! @note |max| must be below 2^22 (float) or 2^51 (double)
+template<class F>
+SPA_KERNEL_INLINE int32_t to_int(F x, F scale, F min, F max)
+{
+	// the rounding trick, min and max map to vector instructions,
+	// unlike std::nearbyint without SSE4.1. Values too large for the
+	// trick stay too large, so clipping afterwards is still correct,
+	// and GCC only vectorizes this order.
+	const F v = (x * scale + round_magic<F>()) - round_magic<F>();
+	// std::max(min, v) is min unless min < v, so it is also min for
+	// NaN, which must not reach the cast
+	return static_cast<int32_t>(std::min(std::max(min, v), max));
+}
+
+SPA_KERNEL_INLINE void store24(int24_t& dst, int32_t v)
+{
+	dst.bytes[0] = static_cast<uint8_t>(v & 0xFF);
+	dst.bytes[1] = static_cast<uint8_t>((v >> 8) & 0xFF);
+	dst.bytes[2] = static_cast<uint8_t>((v >> 16) & 0xFF);
+}
+
+SPA_KERNEL_INLINE int32_t load24(const int24_t& src)
+{
+	// shift into the upper bytes first to get the sign extension
+	uint32_t u = (static_cast<uint32_t>(src.bytes[0]) << 8)
+		| (static_cast<uint32_t>(src.bytes[1]) << 16)
+		| (static_cast<uint32_t>(src.bytes[2]) << 24);
+	return static_cast<int32_t>(u) >> 8;
+}
+
+constexpr float scale16 = 32768.0f;
+constexpr double scale24 = 8388608.0;
+constexpr double scale32 = 2147483648.0;
+
+//! number of partial results for reductions, such that they can be
+//! vectorized without reordering float additions
+constexpr std::size_t lanes = 16;
+
+/*
+	kernel implementations
+	they are compiled once for each instruction set, so write them such
+	that the compiler can vectorize them
+*/
+
+namespace impl {
+
+SPA_KERNEL_INLINE void gain(const float* src, float* dst, float g,
+	std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		dst[i] = src[i] * g;
+}
+
+SPA_KERNEL_INLINE void gain_ramp(const float* src, float* dst, float start,
+	float step, std::size_t n)
+{
+	// 32 bit indices can be converted to float in vector registers
+	constexpr std::size_t chunk = 1 << 16;
+	for(std::size_t pos = 0; pos < n; pos += chunk)
+	{
+		const int len = static_cast<int>(std::min(chunk, n - pos));
+		const float s = start + step * static_cast<float>(pos);
+		const float* sp = src + pos;
+		float* dp = dst + pos;
+		for(int i = 0; i < len; ++i)
+			dp[i] = sp[i] * (s + step * static_cast<float>(i));
+	}
+}
+
+SPA_KERNEL_INLINE void mix(const float* src, float* dst, std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		dst[i] += src[i];
+}
+
+SPA_KERNEL_INLINE void mix_gain(const float* src, float* dst, float g,
+	std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		dst[i] += src[i] * g;
+}
+
+SPA_KERNEL_INLINE void pan(const float* src, float* left, float* right,
+	float gl, float gr, std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+	{
+		const float x = src[i];
+		left[i] = x * gl;
+		right[i] = x * gr;
+	}
+}
+
+SPA_KERNEL_INLINE void copy(const float* src, float* dst, std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		dst[i] = src[i];
+}
+
+SPA_KERNEL_INLINE void clear(float* dst, std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		dst[i] = 0.0f;
+}
+
+SPA_KERNEL_INLINE float peak(const float* src, std::size_t n)
+{
+	// Without the sign bit, floats compare like their bit patterns as
+	// integers, and integer max reductions are vectorized without
+	// -ffast-math. A NaN compares larger than infinity, so it makes
+	// the result NaN.
+	int32_t res = 0;
+	for(std::size_t i = 0; i < n; ++i)
+	{
+		int32_t bits;
+		std::memcpy(&bits, src + i, sizeof(bits));
+		res = std::max(res, bits & 0x7fffffff);
+	}
+	float f;
+	std::memcpy(&f, &res, sizeof(f));
+	return f;
+}
+
+SPA_KERNEL_INLINE float sum_squares(const float* src, std::size_t n)
+{
+	float part[lanes] = {};
+	std::size_t i = 0;
+	for(; i + lanes <= n; i += lanes)
+		for(std::size_t l = 0; l < lanes; ++l)
+			part[l] += src[i + l] * src[i + l];
+	float res = 0.0f;
+	for(std::size_t l = 0; l < lanes; ++l)
+		res += part[l];
+	for(; i < n; ++i)
+		res += src[i] * src[i];
+	return res;
+}
+
+SPA_KERNEL_INLINE void interleave(const float* const* src, float* dst,
+	unsigned channels, std::size_t n)
+{
+	if(channels == 2)
+	{
+		const float* l = src[0];
+		const float* r = src[1];
+		for(std::size_t i = 0; i < n; ++i)
+		{
+			dst[2 * i] = l[i];
+			dst[2 * i + 1] = r[i];
+		}
+	}
+	else
+	{
+		for(unsigned c = 0; c < channels; ++c)
+		{
+			const float* s = src[c];
+			for(std::size_t i = 0; i < n; ++i)
+				dst[i * channels + c] = s[i];
+		}
+	}
+}
+
+SPA_KERNEL_INLINE void deinterleave(const float* src, float* const* dst,
+	unsigned channels, std::size_t n)
+{
+	if(channels == 2)
+	{
+		float* l = dst[0];
+		float* r = dst[1];
+		for(std::size_t i = 0; i < n; ++i)
+		{
+			l[i] = src[2 * i];
+			r[i] = src[2 * i + 1];
+		}
+	}
+	else
+	{
+		for(unsigned c = 0; c < channels; ++c)
+		{
+			float* d = dst[c];
+			for(std::size_t i = 0; i < n; ++i)
+				d[i] = src[i * channels + c];
+		}
+	}
+}
+
+SPA_KERNEL_INLINE void f32_to_f64(const float* src, double* dst,
+	std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		dst[i] = static_cast<double>(src[i]);
+}
+
+SPA_KERNEL_INLINE void f64_to_f32(const double* src, float* dst,
+	std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		dst[i] = static_cast<float>(src[i]);
+}
+
+SPA_KERNEL_INLINE void s16_to_f32(const int16_t* src, float* dst,
+	std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		dst[i] = static_cast<float>(src[i]) * (1.0f / scale16);
+}
+
+SPA_KERNEL_INLINE void s24_to_f32(const int24_t* src, float* dst,
+	std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		dst[i] = static_cast<float>(load24(src[i]))
+			* static_cast<float>(1.0 / scale24);
+}
+
+SPA_KERNEL_INLINE void s32_to_f32(const int32_t* src, float* dst,
+	std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		dst[i] = static_cast<float>(
+			static_cast<double>(src[i]) * (1.0 / scale32));
+}
+
+SPA_KERNEL_INLINE void f32_to_s16(const float* src, int16_t* dst,
+	std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		dst[i] = static_cast<int16_t>(to_int(src[i], scale16,
+			-scale16, scale16 - 1.0f));
+}
+
+SPA_KERNEL_INLINE void f32_to_s24(const float* src, int24_t* dst,
+	std::size_t n)
+{
+	// float can not represent all 24 bit values +0.5, so use double
+	for(std::size_t i = 0; i < n; ++i)
+		store24(dst[i], to_int(static_cast<double>(src[i]),
+			scale24, -scale24, scale24 - 1.0));
+}
+
+SPA_KERNEL_INLINE void f32_to_s32(const float* src, int32_t* dst,
+	std::size_t n)
+{
+	for(std::size_t i = 0; i < n; ++i)
+		dst[i] = to_int(static_cast<double>(src[i]),
+			scale32, -scale32, scale32 - 1.0);
+}
+
+} // namespace impl
+
+//! the kernels for one instruction set
+struct kernel_table
+{
+	void (*gain)(const float*, float*, float, std::size_t);
+	void (*gain_ramp)(const float*, float*, float, float, std::size_t);
+	void (*mix)(const float*, float*, std::size_t);
+	void (*mix_gain)(const float*, float*, float, std::size_t);
+	void (*pan)(const float*, float*, float*, float, float, std::size_t);
+	void (*copy)(const float*, float*, std::size_t);
+	void (*clear)(float*, std::size_t);
+	float (*peak)(const float*, std::size_t);
+	float (*sum_squares)(const float*, std::size_t);
+	void (*interleave)(const float* const*, float*, unsigned,
+		std::size_t);
+	void (*deinterleave)(const float*, float* const*, unsigned,
+		std::size_t);
+	void (*f32_to_f64)(const float*, double*, std::size_t);
+	void (*f64_to_f32)(const double*, float*, std::size_t);
+	void (*s16_to_f32)(const int16_t*, float*, std::size_t);
+	void (*s24_to_f32)(const int24_t*, float*, std::size_t);
+	void (*s32_to_f32)(const int32_t*, float*, std::size_t);
+	void (*f32_to_s16)(const float*, int16_t*, std::size_t);
+	void (*f32_to_s24)(const float*, int24_t*, std::size_t);
+	void (*f32_to_s32)(const float*, int32_t*, std::size_t);
+};
+
+//! compile all kernels for one instruction set into namespace @p ns,
+//! using the function attributes @p attr, and provide a kernel_table
+#define SPA_KERNEL_SET(ns, attr) \
+namespace ns { \
+	template<class R, class ...Args> \
+	struct wrap \
+	{ \
+		template<R (*F)(Args...)> \
+		attr static R call(Args... args) { return F(args...); } \
+	}; \
+	template<class R, class ...Args> \
+	constexpr wrap<R, Args...> mk(R (*)(Args...)) { return {}; } \
+	const kernel_table table = { \
+		&decltype(mk(impl::gain))::call<impl::gain>, \
+		&decltype(mk(impl::gain_ramp))::call<impl::gain_ramp>, \
+		&decltype(mk(impl::mix))::call<impl::mix>, \
+		&decltype(mk(impl::mix_gain))::call<impl::mix_gain>, \
+		&decltype(mk(impl::pan))::call<impl::pan>, \
+		&decltype(mk(impl::copy))::call<impl::copy>, \
+		&decltype(mk(impl::clear))::call<impl::clear>, \
+		&decltype(mk(impl::peak))::call<impl::peak>, \
+		&decltype(mk(impl::sum_squares))::call<impl::sum_squares>, \
+		&decltype(mk(impl::interleave))::call<impl::interleave>, \
+		&decltype(mk(impl::deinterleave))::call<impl::deinterleave>, \
+		&decltype(mk(impl::f32_to_f64))::call<impl::f32_to_f64>, \
+		&decltype(mk(impl::f64_to_f32))::call<impl::f64_to_f32>, \
+		&decltype(mk(impl::s16_to_f32))::call<impl::s16_to_f32>, \
+		&decltype(mk(impl::s24_to_f32))::call<impl::s24_to_f32>, \
+		&decltype(mk(impl::s32_to_f32))::call<impl::s32_to_f32>, \
+		&decltype(mk(impl::f32_to_s16))::call<impl::f32_to_s16>, \
+		&decltype(mk(impl::f32_to_s24))::call<impl::f32_to_s24>, \
+		&decltype(mk(impl::f32_to_s32))::call<impl::f32_to_s32> \
+	}; \
+}
+
+SPA_KERNEL_SET(scalar, )
+#if defined(__x86_64__) || defined(__i386__)
+SPA_KERNEL_SET(sse2, __attribute__((target("sse2"))))
+SPA_KERNEL_SET(avx2, __attribute__((target("avx2,fma"))))
+SPA_KERNEL_SET(avx512, __attribute__((target("avx512f"))))
+#endif
+
+#undef SPA_KERNEL_SET
+#undef SPA_KERNEL_INLINE
+
+bool supported(simd_t level)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_cpu_init();
+	switch(level)
+	{
+		case simd_t::scalar: return true;
+		case simd_t::sse2: return __builtin_cpu_supports("sse2");
+		case simd_t::avx2: return __builtin_cpu_supports("avx2")
+			&& __builtin_cpu_supports("fma");
+		case simd_t::avx512: return __builtin_cpu_supports("avx512f");
+	}
+	return false;
+#else
+	return level == simd_t::scalar;
+#endif
+}
+
+const kernel_table& table_for(simd_t level)
+{
+	switch(level)
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		case simd_t::sse2: return sse2::table;
+		case simd_t::avx2: return avx2::table;
+		case simd_t::avx512: return avx512::table;
+#endif
+		default: return scalar::table;
+	}
+}
+
+//! best supported level that is not better than @p level
+simd_t best_supported(simd_t level)
+{
+	int l = static_cast<int>(level);
+	for(; l > 0 && !supported(static_cast<simd_t>(l)); --l) ;
+	return static_cast<simd_t>(l);
+}
+
+//! the kernels in use, which set_simd() may exchange while other
+//! threads call them
+struct active_t
+{
+	std::atomic<simd_t> level;
+	std::atomic<const kernel_table*> table;
+};
+
+active_t& active()
+{
+	static active_t a { { best_supported(simd_t::avx512) },
+		{ &table_for(best_supported(simd_t::avx512)) } };
+	return a;
+}
+
+const kernel_table& kernels() {
+	return *active().table.load(std::memory_order_acquire); }
+
+}
+
+/*
+	instruction sets
+*/
+
+simd_t simd() { return active().level.load(std::memory_order_relaxed); }
+
+simd_t set_simd(simd_t level)
+{
+	active_t& a = active();
+	const simd_t best = best_supported(level);
+	a.level.store(best, std::memory_order_relaxed);
+	a.table.store(&table_for(best), std::memory_order_release);
+	return best;
+}
+
+/*
+	kernels
+*/
+
+void gain(const float* src, float* dst, float g, std::size_t n) {
+	kernels().gain(src, dst, g, n); }
+
+void gain_ramp(const float* src, float* dst, float start, float step,
+	std::size_t n) {
+	kernels().gain_ramp(src, dst, start, step, n); }
+
+void mix(const float* src, float* dst, std::size_t n) {
+	kernels().mix(src, dst, n); }
+
+void mix_gain(const float* src, float* dst, float g, std::size_t n) {
+	kernels().mix_gain(src, dst, g, n); }
+
+void pan(const float* src, float* left, float* right, float pan,
+	std::size_t n)
+{
+	// constant power pan law
+	const float angle = (pan + 1.0f) * static_cast<float>(M_PI / 4.0);
+	kernels().pan(src, left, right, std::cos(angle), std::sin(angle), n);
+}
+
+void copy(const float* src, float* dst, std::size_t n) {
+	kernels().copy(src, dst, n); }
+
+void clear(float* dst, std::size_t n) { kernels().clear(dst, n); }
+
+float peak(const float* src, std::size_t n) {
+	return kernels().peak(src, n); }
+
+float rms(const float* src, std::size_t n) {
+	return n ? std::sqrt(kernels().sum_squares(src, n) / n) : 0.0f; }
+
+void interleave(const float* const* src, float* dst, unsigned channels,
+	std::size_t n) {
+	kernels().interleave(src, dst, channels, n); }
+
+void deinterleave(const float* src, float* const* dst, unsigned channels,
+	std::size_t n) {
+	kernels().deinterleave(src, dst, channels, n); }
+
+/*
+	sample format conversion
+*/
+
+void convert(const float* src, double* dst, std::size_t n) {
+	kernels().f32_to_f64(src, dst, n); }
+
+void convert(const double* src, float* dst, std::size_t n) {
+	kernels().f64_to_f32(src, dst, n); }
+
+void convert(const int16_t* src, float* dst, std::size_t n) {
+	kernels().s16_to_f32(src, dst, n); }
+
+void convert(const int24_t* src, float* dst, std::size_t n) {
+	kernels().s24_to_f32(src, dst, n); }
+
+void convert(const int32_t* src, float* dst, std::size_t n) {
+	kernels().s32_to_f32(src, dst, n); }
+
+void convert(const float* src, int16_t* dst, std::size_t n,
+	dither_t dither, dither_state* state)
+{
+	if(dither == dither_t::none)
+		kernels().f32_to_s16(src, dst, n);
+	else
+	{
+		// the noise generator is a loop carried dependency
+		for(std::size_t i = 0; i < n; ++i)
+			dst[i] = static_cast<int16_t>(to_int(src[i]
+				+ dither_noise(dither, *state) / scale16,
+				scale16, -scale16, scale16 - 1.0f));
+	}
+}
+
+void convert(const float* src, int24_t* dst, std::size_t n,
+	dither_t dither, dither_state* state)
+{
+	if(dither == dither_t::none)
+		kernels().f32_to_s24(src, dst, n);
+	else
+	{
+		for(std::size_t i = 0; i < n; ++i)
+			store24(dst[i], to_int(static_cast<double>(src[i])
+				+ dither_noise(dither, *state) / scale24,
+				scale24, -scale24, scale24 - 1.0));
+	}
+}
+
+void convert(const float* src, int32_t* dst, std::size_t n) {
+	// float has only 24 bits of precision, so dithering is useless here
+	kernels().f32_to_s32(src, dst, n); }
+
+} // namespace audio
+} // namespace spa
+
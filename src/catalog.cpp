@@ -0,0 +1,118 @@
+#include <spa/catalog.h>
+
+namespace spa {
+namespace host {
+
+constexpr std::uint32_t catalog::empty;
+
+catalog::catalog(std::size_t capacity)
+{
+	reserve(capacity);
+}
+
+std::size_t catalog::slot(std::uint64_t id) const
+{
+	// Fibonacci hashing, in case that the IDs are not well distributed
+	return static_cast<std::size_t>(
+		(id * 0x9e3779b97f4a7c15ull) >> 32) & (slots.size() - 1);
+}
+
+void catalog::rehash(std::size_t slot_count)
+{
+	std::vector<entry> old(slot_count, entry { 0, empty, 0 });
+	old.swap(slots);
+	count = 0;
+	for(const entry& e : old)
+		if(e.library != empty)
+			insert(e.id, e.library, e.index);
+}
+
+void catalog::reserve(std::size_t capacity)
+{
+	// keep the load factor at most 1/2, so probe sequences stay short
+	std::size_t slot_count = 16;
+	while(slot_count < capacity * 2)
+		slot_count *= 2;
+	if(slot_count > slots.size())
+		rehash(slot_count);
+}
+
+void catalog::clear()
+{
+	slots.clear();
+	count = 0;
+	paths.clear();
+}
+
+void catalog::add(const library_info& info)
+{
+	if(info.plugins.empty())
+		return;
+	const std::uint32_t library = paths.size();
+	paths.push_back(info.path);
+	for(const plugin_info& p : info.plugins)
+		insert(p.id, library, p.index);
+}
+
+bool catalog::insert(std::uint64_t id, std::uint32_t library,
+	std::uint32_t index)
+{
+	if((count + 1) * 2 > slots.size())
+		reserve(count + 1);
+	const std::size_t mask = slots.size() - 1;
+	std::size_t i = slot(id);
+	for(; slots[i].library != empty; i = (i + 1) & mask)
+		if(slots[i].id == id)
+		{
+			slots[i].library = library;
+			slots[i].index = index;
+			return false;
+		}
+	slots[i] = entry { id, library, index };
+	++count;
+	return true;
+}
+
+const catalog::entry* catalog::find(std::uint64_t id) const
+{
+	if(slots.empty())
+		return nullptr;
+	const std::size_t mask = slots.size() - 1;
+	for(std::size_t i = slot(id); slots[i].library != empty;
+		i = (i + 1) & mask)
+		if(slots[i].id == id)
+			return &slots[i];
+	return nullptr;
+}
+
+bool catalog::erase(std::uint64_t id)
+{
+	const entry* e = find(id);
+	if(!e)
+		return false;
+	const std::size_t mask = slots.size() - 1;
+	std::size_t hole = e - slots.data();
+	slots[hole].library = empty;
+	--count;
+
+	// move entries behind the hole back if their probe sequence passes
+	// the hole, so find() does not stop too early
+	for(std::size_t i = (hole + 1) & mask; slots[i].library != empty;
+		i = (i + 1) & mask)
+	{
+		const std::size_t home = slot(slots[i].id);
+		const bool home_in_gap = (hole <= i)
+			? (hole < home && home <= i)
+			: (hole < home || home <= i);
+		if(!home_in_gap)
+		{
+			slots[hole] = slots[i];
+			slots[i].library = empty;
+			hole = i;
+		}
+	}
+	return true;
+}
+
+} // namespace host
+} // namespace spa
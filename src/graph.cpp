@@ -0,0 +1,890 @@
+#include <atomic>
+#include <deque>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include <spa/audio_dsp.h>
+#include <spa/graph.h>
+#include <spa/scheduler.h>
+
+namespace spa {
+namespace host {
+
+namespace {
+
+//! size of the ringbuffers for OSC outputs that are not connected
+constexpr std::size_t unconnected_osc_size = 1 << 16;
+
+//! Assigns buffers to the values that the steps of a schedule write,
+//! reusing buffers whose values have been read completely (like register
+//! allocation), so large graphs only touch a few buffers per block
+class buffer_pool
+{
+	using buffer_vector =
+		std::vector<std::unique_ptr<spa::audio::aligned_buffer>>;
+
+	struct slot
+	{
+		//! steps reading the current value
+		std::vector<unsigned> readers;
+		//! never reuse it (e.g. the host reads or writes it)
+		bool pinned;
+	};
+
+	buffer_vector& buffers;
+	std::vector<slot> slots;
+	unsigned size;
+	//! for each step, a bitset of the steps that depend on it, or
+	//! empty if the steps run in schedule order
+	std::vector<std::vector<uint64_t>> reach;
+
+	//! whether step @p from is done before step @p to starts
+	bool before(unsigned from, unsigned to) const
+	{
+		return reach.empty() ? from < to
+			: !!(reach[from][to / 64] & (uint64_t(1) << (to % 64)));
+	}
+
+	//! whether @p step can write to slot @p s
+	//! @param self whether @p step itself may still read the old value
+	bool writable(const slot& s, unsigned step, bool self) const
+	{
+		if(s.pinned)
+			return false;
+		for(unsigned r : s.readers)
+			if(!(self && r == step) && !before(r, step))
+				return false;
+		return true;
+	}
+
+public:
+	buffer_pool(buffer_vector& buffers, unsigned size) :
+		buffers(buffers), size(size) {}
+
+	//! let steps run in any order that respects @p successors
+	void set_dependencies(
+		const std::vector<std::vector<unsigned>>& successors)
+	{
+		const std::size_t n = successors.size();
+		reach.assign(n, std::vector<uint64_t>((n + 63) / 64));
+		// successors always come later in the schedule
+		for(std::size_t i = n; i-- > 0; )
+			for(unsigned next : successors[i])
+			{
+				reach[i][next / 64] |=
+					uint64_t(1) << (next % 64);
+				for(std::size_t w = 0; w < reach[i].size(); ++w)
+					reach[i][w] |= reach[next][w];
+			}
+	}
+
+	//! get a buffer for a value that @p step writes
+	//! @param readers the steps that read the value
+	//! @param in_place a buffer that @p step reads, which it may also
+	//!   write to, if nobody else reads it afterwards
+	float* alloc(unsigned step, std::vector<unsigned> readers,
+		bool pinned = false, const float* in_place = nullptr)
+	{
+		std::size_t idx = 0;
+		for(; idx < slots.size(); ++idx)
+			if(buffers[idx]->data() == in_place
+				&& writable(slots[idx], step, true))
+				break;
+		if(idx == slots.size())
+			for(idx = 0; idx < slots.size(); ++idx)
+				if(writable(slots[idx], step, false))
+					break;
+		if(idx == slots.size())
+		{
+			buffers.emplace_back(new spa::audio::aligned_buffer);
+			buffers.back()->resize(size);
+			slots.push_back(slot());
+		}
+		slots[idx].readers = std::move(readers);
+		slots[idx].pinned = pinned;
+		return buffers[idx]->data();
+	}
+};
+
+}
+
+/*
+	nodes
+*/
+
+//! an audio port, with one buffer per channel
+struct graph::audio_port
+{
+	std::string name;
+	bool output;
+	unsigned channels;
+	spa::audio::signal_info* signal;
+	//! pass the buffers from table to the plugin
+	std::function<void(float* const*)> set;
+	//! buffer of each channel, assigned by compile()
+	std::vector<float*> table;
+};
+
+struct graph::osc_port
+{
+	std::string name;
+	//! exactly one of in and out is set
+	spa::audio::osc_ringbuffer_in* in;
+	spa::audio::osc_ringbuffer_out* out;
+	//! ringbuffer of an input, or of an output that is not connected
+	//! (connected outputs write into the ringbuffer of the input)
+	std::unique_ptr<spa::audio::osc_ringbuffer> rb;
+};
+
+struct graph::node
+{
+	const spa::descriptor* desc;
+	std::unique_ptr<spa::plugin> plugin;
+	std::vector<audio_port> audio;
+	std::vector<osc_port> osc;
+
+	struct control
+	{
+		std::string name;
+		//! convert a value to the port's type and store it
+		std::function<void(double)> set;
+	};
+	std::vector<control> controls;
+	//! storage of the control ports, of any type
+	std::vector<std::shared_ptr<void>> values;
+
+	unsigned tail = spa::audio::tail_length::infinite;
+	bool decayed = false;
+	unsigned latency = 0;
+	//! number of samples the plugin has been run with silent inputs and
+	//! without events
+	unsigned long silent_samples = 0;
+	bool active = false;
+
+	~node()
+	{
+		if(active)
+			plugin->deactivate();
+	}
+};
+
+//! connects all ports of one plugin to the graph
+struct graph::visitor : public virtual spa::audio::visitor
+{
+	graph* g;
+	node* n;
+	const char* name;
+	using spa::audio::visitor::visit;
+
+	void set_contract(spa::audio::buffer_contract& p)
+	{
+		using buf = spa::audio::aligned_buffer;
+		p.alignment = buf::default_alignment;
+		p.padding = buf::default_padding;
+		if(!p.accepts(p.alignment, p.padding))
+			throw spa::exception("plugin does not accept the "
+				"buffer alignment or padding");
+	}
+
+	void add_audio(bool output, unsigned channels,
+		spa::audio::signal_info& sig,
+		std::function<void(float* const*)> set)
+	{
+		n->audio.push_back(audio_port { name, output, channels, &sig,
+			std::move(set), std::vector<float*>(channels) });
+	}
+
+	void visit(spa::audio::in& p) override {
+		set_contract(p);
+		add_audio(false, 1, p, [&p](float* const* t) {
+			p.set_ref(t[0]); }); }
+	void visit(spa::audio::out& p) override {
+		set_contract(p);
+		add_audio(true, 1, p, [&p](float* const* t) {
+			p.set_ref(t[0]); }); }
+	void visit(spa::audio::stereo::in& p) override {
+		set_contract(p);
+		add_audio(false, 2, p, [&p](float* const* t) {
+			p.left = t[0]; p.right = t[1]; }); }
+	void visit(spa::audio::stereo::out& p) override {
+		set_contract(p);
+		add_audio(true, 2, p, [&p](float* const* t) {
+			p.left = t[0]; p.right = t[1]; }); }
+	void check_layout(spa::audio::bus::layout_t layout)
+	{
+		// the graph keeps one buffer per channel
+		if(layout != spa::audio::bus::layout_t::planar)
+			throw spa::exception("graph does not support "
+				"interleaved audio buses");
+	}
+
+	void visit(spa::audio::bus::in& p) override {
+		check_layout(p.layout);
+		set_contract(p);
+		add_audio(false, p.channels, p, [&p](float* const* t) {
+			p.data = t; }); }
+	void visit(spa::audio::bus::out& p) override {
+		check_layout(p.layout);
+		set_contract(p);
+		add_audio(true, p.channels, p, [&p](float* const* t) {
+			p.data = t; }); }
+
+	void visit(spa::audio::osc_ringbuffer_in& p) override {
+		std::unique_ptr<spa::audio::osc_ringbuffer> rb(
+			new spa::audio::osc_ringbuffer(p.get_size()));
+		p.connect(*rb);
+		n->osc.push_back(osc_port { name, &p, nullptr, std::move(rb) });
+	}
+	void visit(spa::audio::osc_ringbuffer_out& p) override {
+		std::unique_ptr<spa::audio::osc_ringbuffer> rb(
+			new spa::audio::osc_ringbuffer(unconnected_osc_size));
+		p.set_ref(rb.get());
+		n->osc.push_back(osc_port { name, nullptr, &p, std::move(rb) });
+	}
+
+	void visit(spa::audio::samplerate& p) override {
+		p.set_ref(&g->samplerate); }
+	void visit(spa::audio::buffersize& p) override {
+		p.set_ref(&g->max_frames); }
+	void visit(spa::audio::samplecount& p) override {
+		p.set_ref(&g->frames); }
+	void visit(spa::audio::tail_length& p) override {
+		p.set_ref(&n->tail); }
+	void visit(spa::audio::decayed& p) override {
+		p.set_ref(&n->decayed); }
+	void visit(spa::audio::latency& p) override {
+		p.set_ref(&n->latency); }
+
+	template<class T, class Init>
+	T* store(const Init& init)
+	{
+		std::shared_ptr<T> value = std::make_shared<T>(init);
+		n->values.push_back(value);
+		return value.get();
+	}
+	template<class T>
+	void add_control(spa::audio::control_in<T>& p)
+	{
+		T* value = store<T>(p.def);
+		n->controls.push_back({ name, [value](double v) {
+			*value = static_cast<T>(v); } });
+		p.set_ref(value);
+	}
+	template<class T>
+	void add_control(spa::audio::atomic_control_in<T>& p)
+	{
+		std::atomic<T>* value = store<std::atomic<T>>(p.def);
+		n->controls.push_back({ name, [value](double v) {
+			value->store(static_cast<T>(v),
+				std::memory_order_release); } });
+		p.set_ref(value);
+	}
+	template<class T>
+	void add_control(spa::audio::control_out<T>& p) {
+		p.set_ref(store<T>(T())); }
+
+#define SPA_GRAPH_VISIT_CONTROLS(type) \
+	void visit(spa::audio::control_in<type>& p) override { \
+		add_control(p); } \
+	void visit(spa::audio::atomic_control_in<type>& p) override { \
+		add_control(p); } \
+	void visit(spa::audio::control_out<type>& p) override { \
+		add_control(p); }
+#define SPA_GRAPH_VISIT_CONTROLS2(type) \
+	SPA_GRAPH_VISIT_CONTROLS(type) \
+	SPA_GRAPH_VISIT_CONTROLS(unsigned type)
+
+	SPA_GRAPH_VISIT_CONTROLS(bool)
+	SPA_GRAPH_VISIT_CONTROLS2(char)
+	SPA_GRAPH_VISIT_CONTROLS2(short)
+	SPA_GRAPH_VISIT_CONTROLS2(int)
+	SPA_GRAPH_VISIT_CONTROLS2(long)
+	SPA_GRAPH_VISIT_CONTROLS2(long long)
+	SPA_GRAPH_VISIT_CONTROLS(float)
+	SPA_GRAPH_VISIT_CONTROLS(double)
+
+#undef SPA_GRAPH_VISIT_CONTROLS2
+#undef SPA_GRAPH_VISIT_CONTROLS
+
+	// ports that the graph can not provide, which the plugin would
+	// otherwise find unconnected in run()
+	void unsupported()
+	{
+		throw spa::exception("graph does not support the type of "
+			"a port");
+	}
+	void visit(spa::audio::param_block_in& ) override {
+		unsupported(); }
+	void visit(spa::audio::osc_lanes_in& ) override { unsupported(); }
+	void visit(spa::blob_return_out& ) override { unsupported(); }
+	void visit(spa::audio::sample_in<double>& ) override {
+		unsupported(); }
+	void visit(spa::audio::sample_out<double>& ) override {
+		unsupported(); }
+	void visit(spa::audio::sample_in<int16_t>& ) override {
+		unsupported(); }
+	void visit(spa::audio::sample_out<int16_t>& ) override {
+		unsupported(); }
+	void visit(spa::audio::sample_in<spa::audio::int24_t>& ) override {
+		unsupported(); }
+	void visit(spa::audio::sample_out<spa::audio::int24_t>& ) override {
+		unsupported(); }
+	void visit(spa::audio::sample_in<int32_t>& ) override {
+		unsupported(); }
+	void visit(spa::audio::sample_out<int32_t>& ) override {
+		unsupported(); }
+
+	void visit(spa::port_ref_base& p) override {
+		if(p.compulsory() || p.initial())
+			throw spa::port_not_found(name); }
+};
+
+/*
+	building the graph
+*/
+
+graph::graph(unsigned buffersize, long samplerate) :
+	max_frames(buffersize), samplerate(samplerate), skip_count(0) {}
+
+graph::~graph()
+{
+	// stop the workers before the plugins are deleted
+	sched.reset();
+}
+
+graph::node& graph::get(node_id id) const
+{
+	if(id >= nodes.size() || !nodes[id])
+		throw spa::exception("invalid graph node");
+	return *nodes[id];
+}
+
+graph::node_id graph::add(const spa::descriptor& desc)
+{
+	spa::assert_versions_match(desc);
+
+	std::unique_ptr<node> n(new node);
+	n->desc = &desc;
+	n->plugin.reset(desc.instantiate());
+
+	visitor v;
+	v.g = this;
+	v.n = n.get();
+	auto connect = [&](const char* name) {
+		v.name = name;
+		n->plugin->port(name).accept(v);
+	};
+	// the static table does not need any allocations
+	if(const char* const* table = desc.port_name_table())
+		for(; *table; ++table)
+			connect(*table);
+	else
+		for(const spa::simple_str& port_name : desc.port_names())
+			connect(port_name.data());
+
+	n->plugin->init();
+	n->plugin->activate();
+	n->active = true;
+
+	nodes.push_back(std::move(n));
+	compiled = false;
+	return nodes.size() - 1;
+}
+
+void graph::remove(node_id id)
+{
+	get(id);
+	std::vector<edge> remaining;
+	for(const edge& e : edges)
+		if(e.src != id && e.dst != id)
+			remaining.push_back(e);
+	edges.swap(remaining);
+	nodes[id].reset();
+	compiled = false;
+}
+
+void graph::find_port(const node& n, const char* name,
+	unsigned& idx, bool& osc) const
+{
+	osc = false;
+	for(idx = 0; idx < n.audio.size(); ++idx)
+		if(n.audio[idx].name == name)
+			return;
+	osc = true;
+	for(idx = 0; idx < n.osc.size(); ++idx)
+		if(n.osc[idx].name == name)
+			return;
+	throw spa::port_not_found(name);
+}
+
+void graph::connect(node_id src, const char* out,
+	node_id dst, const char* in)
+{
+	edge e { src, dst, 0, 0, false };
+	bool dst_osc;
+	const node& s = get(src);
+	const node& d = get(dst);
+	find_port(s, out, e.src_port, e.osc);
+	find_port(d, in, e.dst_port, dst_osc);
+
+	if(e.osc != dst_osc)
+		throw spa::exception("can not connect audio and OSC ports");
+	if(e.osc)
+	{
+		if(!s.osc[e.src_port].out || !d.osc[e.dst_port].in)
+			throw spa::exception("OSC ports have wrong directions");
+		for(const edge& other : edges)
+			if(other.osc && ((other.dst == dst &&
+				other.dst_port == e.dst_port) ||
+				(other.src == src &&
+				other.src_port == e.src_port)))
+				throw spa::exception("OSC port is already "
+					"connected");
+	}
+	else
+	{
+		const audio_port& o = s.audio[e.src_port];
+		const audio_port& i = d.audio[e.dst_port];
+		if(!o.output || i.output)
+			throw spa::exception("audio ports have wrong "
+				"directions");
+		if(o.channels != i.channels)
+			throw spa::exception("audio ports have different "
+				"numbers of channels");
+	}
+
+	edges.push_back(e);
+	compiled = false;
+}
+
+void graph::disconnect(node_id src, const char* out,
+	node_id dst, const char* in)
+{
+	unsigned src_port, dst_port;
+	bool osc;
+	find_port(get(src), out, src_port, osc);
+	find_port(get(dst), in, dst_port, osc);
+	for(std::size_t i = 0; i < edges.size(); ++i)
+	{
+		const edge& e = edges[i];
+		if(e.src == src && e.dst == dst && e.src_port == src_port &&
+			e.dst_port == dst_port)
+		{
+			edges.erase(edges.begin() + i);
+			compiled = false;
+			return;
+		}
+	}
+}
+
+void graph::set_control(node_id id, const char* port, double value)
+{
+	for(const node::control& c : get(id).controls)
+		if(c.name == port)
+		{
+			c.set(value);
+			return;
+		}
+	throw spa::port_not_found(port);
+}
+
+spa::audio::osc_ringbuffer& graph::osc(node_id id, const char* port)
+{
+	node& n = get(id);
+	unsigned idx;
+	bool osc;
+	find_port(n, port, idx, osc);
+	if(!osc || !n.osc[idx].in)
+		throw spa::port_not_found(port);
+	for(const edge& e : edges)
+		if(e.osc && e.dst == id && e.dst_port == idx)
+			throw spa::exception("OSC input is connected to "
+				"another node");
+	return *n.osc[idx].rb;
+}
+
+spa::audio::osc_ringbuffer& graph::resize_osc(node_id id, const char* port,
+	std::size_t size)
+{
+	osc(id, port);
+	node& n = get(id);
+	unsigned idx;
+	bool is_osc;
+	find_port(n, port, idx, is_osc);
+	osc_port& p = n.osc[idx];
+	std::unique_ptr<spa::audio::osc_ringbuffer> rb(
+		new spa::audio::osc_ringbuffer(size));
+	p.in->switch_to(*rb);
+	// the compiled graph must reset the new one
+	for(osc_reset& r : osc_resets)
+		if(r.rb == p.rb.get())
+			r.rb = rb.get();
+	p.rb = std::move(rb);
+	return *p.rb;
+}
+
+unsigned graph::latency(node_id id) const { return get(id).latency; }
+
+void graph::compile()
+{
+	// topological sort (Kahn's algorithm)
+	std::vector<unsigned> pending(nodes.size(), 0);
+	std::vector<std::vector<node_id>> successors(nodes.size());
+	for(const edge& e : edges)
+	{
+		++pending[e.dst];
+		successors[e.src].push_back(e.dst);
+	}
+	std::vector<node_id> order, ready;
+	for(node_id id = 0; id < nodes.size(); ++id)
+		if(nodes[id] && !pending[id])
+			ready.push_back(id);
+	while(!ready.empty())
+	{
+		node_id id = ready.back();
+		ready.pop_back();
+		order.push_back(id);
+		for(node_id next : successors[id])
+			if(!--pending[next])
+				ready.push_back(next);
+	}
+	std::size_t node_count = 0;
+	for(const std::unique_ptr<node>& n : nodes)
+		node_count += !!n;
+	if(order.size() != node_count)
+		throw spa::exception("graph contains a cycle");
+
+	std::vector<unsigned> index(nodes.size());
+	for(unsigned i = 0; i < order.size(); ++i)
+		index[order[i]] = i;
+	std::vector<std::vector<unsigned>> step_successors(order.size());
+	for(const edge& e : edges)
+		step_successors[index[e.src]].push_back(index[e.dst]);
+
+	schedule.clear();
+	mixes.clear();
+	mix_srcs.clear();
+	sigs.clear();
+	sig_srcs.clear();
+	outs.clear();
+	out_bufs.clear();
+	osc_ins.clear();
+	osc_resets.clear();
+	buffers.clear();
+
+	// with workers, a buffer can only be reused by steps that depend on
+	// all of its readers, otherwise by all later steps
+	buffer_pool pool(buffers, max_frames);
+	if(sched)
+		pool.set_dependencies(step_successors);
+
+	for(unsigned i = 0; i < order.size(); ++i)
+	{
+		const node_id id = order[i];
+		node& n = *nodes[id];
+		step s;
+		s.n = &n;
+
+		s.mix_begin = mixes.size();
+		s.sig_begin = sigs.size();
+		for(unsigned idx = 0; idx < n.audio.size(); ++idx)
+		{
+			audio_port& p = n.audio[idx];
+			if(p.output)
+				continue;
+			std::vector<const audio_port*> srcs;
+			for(const edge& e : edges)
+				if(!e.osc && e.dst == id &&
+					e.dst_port == idx)
+				{
+					node& src = *nodes[e.src];
+					srcs.push_back(&src.audio[e.src_port]);
+				}
+
+			// the host sets the signal of unconnected inputs
+			if(srcs.empty())
+				p.signal->set_signal(
+					spa::audio::signal_t::normal);
+			signal_op sig { p.signal,
+				static_cast<unsigned>(sig_srcs.size()), 0 };
+			for(const audio_port* src : srcs)
+				sig_srcs.push_back(src->signal);
+			sig.src_end = sig_srcs.size();
+			sigs.push_back(sig);
+
+			for(unsigned c = 0; c < p.channels; ++c)
+			{
+				if(srcs.size() == 1)
+					p.table[c] = srcs[0]->table[c];
+				else if(srcs.empty())
+				{
+					// filled by the host
+					p.table[c] = pool.alloc(i, {}, true);
+				}
+				else
+				{
+					// summed up, only read by this step
+					p.table[c] = pool.alloc(i, { i });
+					mix_op m { p.table[c],
+						static_cast<unsigned>(
+						mix_srcs.size()), 0 };
+					for(const audio_port* src : srcs)
+						mix_srcs.push_back(
+							src->table[c]);
+					m.src_end = mix_srcs.size();
+					mixes.push_back(m);
+				}
+			}
+		}
+		s.mix_end = mixes.size();
+		s.sig_end = sigs.size();
+
+		// the n-th output may use the buffers of the n-th input
+		std::vector<const audio_port*> ins;
+		for(const audio_port& p : n.audio)
+			if(!p.output)
+				ins.push_back(&p);
+		unsigned out_count = 0;
+		for(unsigned idx = 0; idx < n.audio.size(); ++idx)
+		{
+			audio_port& p = n.audio[idx];
+			if(!p.output)
+				continue;
+			const audio_port* in = (n.desc->properties.in_place &&
+				out_count < ins.size() &&
+				ins[out_count]->channels == p.channels)
+				? ins[out_count] : nullptr;
+			++out_count;
+
+			// outputs that are not connected are read by the host
+			std::vector<unsigned> readers;
+			for(const edge& e : edges)
+				if(!e.osc && e.src == id && e.src_port == idx)
+					readers.push_back(index[e.dst]);
+			for(unsigned c = 0; c < p.channels; ++c)
+				p.table[c] = pool.alloc(i, readers,
+					readers.empty(),
+					in ? in->table[c] : nullptr);
+		}
+
+		s.out_begin = outs.size();
+		s.buf_begin = out_bufs.size();
+		for(audio_port& p : n.audio)
+		{
+			p.set(p.table.data());
+			if(p.output)
+			{
+				outs.push_back(p.signal);
+				out_bufs.insert(out_bufs.end(),
+					p.table.begin(), p.table.end());
+			}
+		}
+		s.out_end = outs.size();
+		s.buf_end = out_bufs.size();
+
+		s.osc_begin = osc_ins.size();
+		for(osc_port& p : n.osc)
+		{
+			if(p.in)
+			{
+				osc_ins.push_back(p.in);
+				osc_resets.push_back({ p.rb.get(), p.in });
+			}
+			else
+				p.out->set_ref(p.rb.get());
+		}
+		s.osc_end = osc_ins.size();
+
+		schedule.push_back(s);
+	}
+
+	// connected OSC outputs write into the ringbuffer of the input
+	for(const edge& e : edges)
+		if(e.osc)
+			nodes[e.src]->osc[e.src_port].out->set_ref(
+				nodes[e.dst]->osc[e.dst_port].rb.get());
+	for(node_id id : order)
+		for(osc_port& p : nodes[id]->osc)
+			if(p.out && &p.out->ref() == p.rb.get())
+				osc_resets.push_back({ p.rb.get(), nullptr });
+
+	if(sched)
+		sched->prepare(step_successors);
+
+	compiled = true;
+}
+
+void graph::set_workers(unsigned workers)
+{
+	sched.reset(workers ? new scheduler(workers) : nullptr);
+	compiled = false;
+}
+
+/*
+	using the compiled graph
+*/
+
+const graph::audio_port& graph::find_audio(node_id id,
+	const char* port) const
+{
+	const node& n = get(id);
+	unsigned idx;
+	bool osc;
+	find_port(n, port, idx, osc);
+	if(osc)
+		throw spa::port_not_found(port);
+	return n.audio[idx];
+}
+
+unsigned graph::channels(node_id id, const char* port) const
+{
+	return find_audio(id, port).channels;
+}
+
+float* graph::input(node_id id, const char* port, unsigned channel)
+{
+	const audio_port& p = find_audio(id, port);
+	if(p.output || channel >= p.channels)
+		throw spa::port_not_found(port);
+	for(const edge& e : edges)
+		if(!e.osc && e.dst == id && &nodes[id]->audio[e.dst_port] == &p)
+			throw spa::exception("input is connected to a node");
+	return p.table[channel];
+}
+
+void graph::set_input_signal(node_id id, const char* port,
+	spa::audio::signal_t signal, float constant_value)
+{
+	input(id, port, 0);
+	find_audio(id, port).signal->set_signal(signal, constant_value);
+}
+
+const float* graph::output(node_id id, const char* port,
+	unsigned channel) const
+{
+	const audio_port& p = find_audio(id, port);
+	if(!p.output || channel >= p.channels)
+		throw spa::port_not_found(port);
+	for(const edge& e : edges)
+		if(!e.osc && e.src == id && &nodes[id]->audio[e.src_port] == &p)
+			throw spa::exception("output is connected to a node, "
+				"so its buffer gets reused");
+	return p.table[channel];
+}
+
+void graph::run(const step& s, unsigned frames)
+{
+	using spa::audio::signal_t;
+	node& n = *s.n;
+
+	for(unsigned i = s.mix_begin; i < s.mix_end; ++i)
+	{
+		const mix_op& m = mixes[i];
+		spa::audio::copy(mix_srcs[m.src_begin], m.dst, frames);
+		for(unsigned j = m.src_begin + 1; j < m.src_end; ++j)
+			spa::audio::mix(mix_srcs[j], m.dst, frames);
+	}
+
+	bool inputs_silent = true;
+	for(unsigned i = s.sig_begin; i < s.sig_end; ++i)
+	{
+		const signal_op& op = sigs[i];
+		if(op.src_end == op.src_begin)
+			; // filled by the host, see set_input_signal()
+		else if(op.src_end - op.src_begin == 1)
+		{
+			const spa::audio::signal_info& src =
+				*sig_srcs[op.src_begin];
+			op.dst->set_signal(src.signal, src.constant_value);
+		}
+		else
+		{
+			bool silent = true;
+			for(unsigned j = op.src_begin; j < op.src_end; ++j)
+				silent = silent && sig_srcs[j]->silent();
+			op.dst->set_signal(silent ? signal_t::silent
+				: signal_t::normal);
+		}
+		inputs_silent = inputs_silent && op.dst->silent();
+	}
+
+	bool no_events = true;
+	for(unsigned i = s.osc_begin; i < s.osc_end; ++i)
+		no_events = no_events && !osc_ins[i]->read_space();
+
+	// events can excite the plugin like audio input does (e.g. note-on)
+	if(!inputs_silent || !no_events)
+		n.silent_samples = 0;
+	bool idle = n.desc->properties.no_tail || n.decayed ||
+		(n.tail != spa::audio::tail_length::infinite &&
+			n.silent_samples >= n.tail);
+
+	if(idle && inputs_silent && no_events)
+	{
+		// propagate the silence instead of running the plugin
+		for(unsigned i = s.buf_begin; i < s.buf_end; ++i)
+			spa::audio::clear(out_bufs[i], frames);
+		for(unsigned i = s.out_begin; i < s.out_end; ++i)
+			outs[i]->set_signal(signal_t::silent);
+		skip_count.fetch_add(1, std::memory_order_relaxed);
+	}
+	else
+	{
+		for(unsigned i = s.out_begin; i < s.out_end; ++i)
+			outs[i]->set_signal(signal_t::normal);
+		n.plugin->run();
+		// only count the frames after the last event, which may be
+		// anywhere in this block
+		if(inputs_silent && no_events)
+			n.silent_samples += frames;
+	}
+}
+
+void graph::run_task(void* self, unsigned task)
+{
+	graph& g = *static_cast<graph*>(self);
+	g.run(g.schedule[task], g.frames);
+}
+
+void graph::process(unsigned frames)
+{
+	if(!compiled)
+		throw spa::exception("graph has changed, but was not "
+			"compiled");
+	if(frames > max_frames)
+		throw spa::out_of_range(frames, max_frames);
+	this->frames = frames;
+
+	if(sched)
+		sched->run(&graph::run_task, this);
+	else
+		for(const step& s : schedule)
+			run(s, frames);
+
+	// the ringbuffers are linear, so start over once they are read
+	for(const osc_reset& r : osc_resets)
+		if(!r.reader || !r.reader->read_space())
+		{
+			r.rb->reset();
+			if(r.reader)
+				r.reader->reset();
+		}
+}
+
+void graph::reset()
+{
+	for(std::unique_ptr<node>& n : nodes)
+		if(n)
+		{
+			n->plugin->deactivate();
+			n->plugin->activate();
+			// run it again until its tail has decayed
+			n->silent_samples = 0;
+		}
+}
+
+} // namespace host
+} // namespace spa
+
@@ -0,0 +1,812 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include <spa/audio.h>
+#include <spa/graph.h>
+#include <spa/render.h>
+
+namespace spa {
+namespace host {
+
+namespace {
+
+// WAV headers are little endian, and so are the samples, which we
+// read and write in native byte order (i.e. for little endian CPUs)
+
+std::uint32_t get_le(const unsigned char* p, unsigned bytes)
+{
+	std::uint32_t res = 0;
+	for(unsigned i = bytes; i; --i)
+		res = res << 8 | p[i - 1];
+	return res;
+}
+
+void put_le(char* p, std::uint32_t value, unsigned bytes)
+{
+	for(unsigned i = 0; i < bytes; ++i, value >>= 8)
+		p[i] = static_cast<char>(value & 0xff);
+}
+
+enum format_tag : std::uint16_t
+{
+	tag_pcm = 1,
+	tag_float = 3,
+	tag_extensible = 0xfffe
+};
+
+}
+
+/*
+	wav_reader
+*/
+
+wav_reader::wav_reader(const std::string& path) :
+	file(std::fopen(path.c_str(), "rb"))
+{
+	if(!file)
+		throw spa::exception("can not open input file");
+	try
+	{
+		unsigned char buf[40];
+		if(std::fread(buf, 1, 12, file) != 12 ||
+			std::memcmp(buf, "RIFF", 4) ||
+			std::memcmp(buf + 8, "WAVE", 4))
+			throw spa::exception("input is no WAV file");
+
+		// find the format and the data chunk
+		std::uint16_t tag = 0, bits = 0;
+		for(;;)
+		{
+			if(std::fread(buf, 1, 8, file) != 8)
+				throw spa::exception("WAV file has no data");
+			const std::uint32_t size = get_le(buf + 4, 4);
+			if(!std::memcmp(buf, "data", 4))
+			{
+				if(!chans)
+					throw spa::exception("WAV file has no "
+						"format");
+				total = left = size / (chans * sample_bytes);
+				break;
+			}
+			long skip = size + (size & 1); // chunks are padded
+			if(!std::memcmp(buf, "fmt ", 4))
+			{
+				const std::uint32_t n =
+					std::min<std::uint32_t>(size, 40);
+				if(size < 16 ||
+					std::fread(buf, 1, n, file) != n)
+					throw spa::exception("invalid WAV "
+						"format");
+				skip -= n;
+				tag = get_le(buf, 2);
+				chans = get_le(buf + 2, 2);
+				rate = get_le(buf + 4, 4);
+				bits = get_le(buf + 14, 2);
+				if(tag == tag_extensible && size >= 26)
+					tag = get_le(buf + 24, 2);
+				is_float = tag == tag_float;
+				sample_bytes = bits / 8;
+				const bool pcm = tag == tag_pcm && (bits == 16
+					|| bits == 24 || bits == 32);
+				if(!chans || !(pcm || (is_float &&
+					(bits == 32 || bits == 64))))
+					throw spa::exception("unsupported WAV "
+						"format");
+			}
+			if(skip && std::fseek(file, skip, SEEK_CUR))
+				throw spa::exception("invalid WAV file");
+		}
+	} catch(...) {
+		std::fclose(file);
+		throw;
+	}
+}
+
+wav_reader::~wav_reader()
+{
+	std::fclose(file);
+}
+
+std::size_t wav_reader::read(float* dst, std::size_t frames)
+{
+	using namespace spa::audio;
+	frames = std::min<std::uint64_t>(frames, left);
+	raw.resize(frames * chans * sample_bytes);
+	frames = std::fread(raw.data(), chans * sample_bytes, frames, file);
+	// a truncated file ends here
+	left = frames ? left - frames : 0;
+
+	const std::size_t n = frames * chans;
+	const char* src = raw.data();
+	switch(sample_bytes * 8 + is_float)
+	{
+		case 16: convert(reinterpret_cast<const int16_t*>(src), dst, n);
+			break;
+		case 24: convert(reinterpret_cast<const int24_t*>(src), dst, n);
+			break;
+		case 32: convert(reinterpret_cast<const int32_t*>(src), dst, n);
+			break;
+		case 33: std::memcpy(dst, src, n * sizeof(float));
+			break;
+		case 65: convert(reinterpret_cast<const double*>(src), dst, n);
+			break;
+	}
+	return frames;
+}
+
+/*
+	wav_writer
+*/
+
+wav_writer::wav_writer(const std::string& path, unsigned channels,
+	long samplerate, format fmt) :
+	file(std::fopen(path.c_str(), "wb")),
+	chans(channels),
+	rate(samplerate),
+	fmt(fmt)
+{
+	if(!file)
+		throw spa::exception("can not create output file");
+	// the sizes are filled in by close()
+	header();
+}
+
+wav_writer::~wav_writer()
+{
+	try {
+		close();
+	} catch(spa::exception& ) {
+		// can not report it here
+	}
+}
+
+unsigned wav_writer::sample_bytes() const
+{
+	return fmt == format::int16 ? 2 : fmt == format::int24 ? 3 : 4;
+}
+
+void wav_writer::header()
+{
+	const unsigned bytes = sample_bytes();
+	// write() keeps it below the limit
+	const std::uint32_t data_size = total * chans * bytes;
+	char h[44];
+	std::memcpy(h, "RIFF", 4);
+	put_le(h + 4, 36 + data_size, 4);
+	std::memcpy(h + 8, "WAVEfmt ", 8);
+	put_le(h + 16, 16, 4);
+	put_le(h + 20, fmt == format::float32 ? tag_float : tag_pcm, 2);
+	put_le(h + 22, chans, 2);
+	put_le(h + 24, rate, 4);
+	put_le(h + 28, rate * chans * bytes, 4);
+	put_le(h + 32, chans * bytes, 2);
+	put_le(h + 34, bytes * 8, 2);
+	std::memcpy(h + 36, "data", 4);
+	put_le(h + 40, data_size, 4);
+	if(std::fwrite(h, sizeof(h), 1, file) != 1)
+		throw spa::exception("can not write output file");
+}
+
+void wav_writer::write(const float* src, std::size_t frames)
+{
+	using namespace spa::audio;
+	// the RIFF size field must hold the data size plus 36 bytes
+	const std::uint64_t max_frames = (UINT32_MAX - 36)
+		/ (chans * sample_bytes());
+	if(frames > max_frames - total)
+		throw spa::exception("output file would exceed the size "
+			"limit of WAV files");
+	const std::size_t n = frames * chans;
+	const void* data = src;
+	std::size_t bytes = n * sizeof(float);
+	switch(fmt)
+	{
+		case format::float32:
+			break;
+		case format::int16:
+			raw.resize(bytes = n * 2);
+			convert(src, reinterpret_cast<int16_t*>(&raw[0]), n,
+				dither_t::triangular, &dither);
+			data = raw.data();
+			break;
+		case format::int24:
+			raw.resize(bytes = n * 3);
+			convert(src, reinterpret_cast<int24_t*>(&raw[0]), n,
+				dither_t::triangular, &dither);
+			data = raw.data();
+			break;
+	}
+	if(std::fwrite(data, 1, bytes, file) != bytes)
+		throw spa::exception("can not write output file");
+	total += frames;
+}
+
+void wav_writer::close()
+{
+	if(!file)
+		return;
+	bool ok = !std::fseek(file, 0, SEEK_SET);
+	try {
+		if(ok)
+			header();
+	} catch(spa::exception& ) {
+		ok = false;
+	}
+	// close it in any case, so the destructor does not try again
+	ok = !std::fclose(file) && ok;
+	file = nullptr;
+	if(!ok)
+		throw spa::exception("can not write output file");
+}
+
+/*
+	automation
+*/
+
+std::vector<automation_event> load_automation(const std::string& path)
+{
+	using pseudo_rtosc::rtosc_arg_t;
+	std::ifstream in(path);
+	if(!in)
+		throw spa::exception("can not open automation file");
+
+	std::vector<automation_event> res;
+	std::string line, osc_path, types;
+	while(std::getline(in, line))
+	{
+		std::istringstream ss(line);
+		automation_event ev;
+		if(!(ss >> ev.frame))
+		{
+			// empty lines and comments
+			ss.clear();
+			std::string first;
+			if(!(ss >> first) || first[0] == '#')
+				continue;
+			throw spa::exception("invalid automation file");
+		}
+		if(!(ss >> ev.node >> ev.port >> osc_path >> types))
+			throw spa::exception("invalid automation file");
+
+		std::vector<rtosc_arg_t> args(types.size());
+		std::deque<std::string> strings;
+		bool ok = true;
+		for(std::size_t i = 0; i < types.size() && ok; ++i)
+		{
+			rtosc_arg_t& a = args[i];
+			switch(types[i])
+			{
+				case 'i': ok = !!(ss >> a.i); break;
+				case 'h': { long long h; ok = !!(ss >> h);
+					a.h = h; break; }
+				case 'f': ok = !!(ss >> a.f); break;
+				case 'd': ok = !!(ss >> a.d); break;
+				case 's':
+					strings.emplace_back();
+					ok = !!(ss >> strings.back());
+					a.s = strings.back().c_str();
+					break;
+				case 'T': case 'F': break;
+				default: ok = false;
+			}
+		}
+		if(!ok)
+			throw spa::exception("invalid automation file");
+
+		ev.msg.resize(pseudo_rtosc::rtosc_amessage(nullptr, 0,
+			osc_path.c_str(), types.c_str(), args.data()));
+		pseudo_rtosc::rtosc_amessage(&ev.msg[0], ev.msg.size(),
+			osc_path.c_str(), types.c_str(), args.data());
+		res.push_back(std::move(ev));
+	}
+
+	std::stable_sort(res.begin(), res.end(),
+		[](const automation_event& a, const automation_event& b) {
+			return a.frame < b.frame; });
+	return res;
+}
+
+/*
+	rendering
+*/
+
+namespace {
+
+//! interleaved samples passed between threads
+struct block
+{
+	std::vector<float> samples;
+	std::size_t frames = 0;
+};
+
+//! blocking queue of blocks from one thread to another
+class block_queue
+{
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::deque<block*> blocks;
+	bool closed = false;
+public:
+	void push(block* b)
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			blocks.push_back(b);
+		}
+		cv.notify_one();
+	}
+	//! wait for the next block
+	//! @return nullptr if the queue is closed and empty
+	block* pop()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cv.wait(lock, [this]{ return closed || !blocks.empty(); });
+		if(blocks.empty())
+			return nullptr;
+		block* b = blocks.front();
+		blocks.pop_front();
+		return b;
+	}
+	void close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			closed = true;
+		}
+		cv.notify_all();
+	}
+};
+
+//! the reading and the writing thread, and their queues
+//!
+//! Empty blocks circulate from the processing thread to the reader
+//! (free_in), filled ones back (full_in). Processed blocks go to the
+//! writer (full_out) and come back empty (free_out).
+class io_threads
+{
+	std::vector<block> in_blocks, out_blocks;
+	std::thread reader, writer;
+	std::exception_ptr read_error, write_error;
+public:
+	block_queue free_in, full_in, free_out, full_out;
+
+	//! @param cpus the CPUs for the threads, or nullptr to inherit the
+	//!   ones of the calling thread
+	io_threads(wav_reader& in, wav_writer& out, unsigned queue,
+		std::size_t block_frames, unsigned out_channels,
+		const cpu_set_t* cpus) :
+		in_blocks(queue), out_blocks(queue)
+	{
+		for(block& b : in_blocks)
+		{
+			b.samples.resize(block_frames * in.channels());
+			free_in.push(&b);
+		}
+		for(block& b : out_blocks)
+		{
+			b.samples.resize(block_frames * out_channels);
+			free_out.push(&b);
+		}
+
+		reader = std::thread([this, &in, block_frames]{
+			try {
+				while(block* b = free_in.pop())
+				{
+					b->frames = in.read(b->samples.data(),
+						block_frames);
+					full_in.push(b);
+					if(!b->frames)
+						break;
+				}
+			} catch(...) {
+				read_error = std::current_exception();
+				full_in.close();
+			}
+		});
+		writer = std::thread([this, &out]{
+			try {
+				while(block* b = full_out.pop())
+				{
+					out.write(b->samples.data(), b->frames);
+					free_out.push(b);
+				}
+			} catch(...) {
+				write_error = std::current_exception();
+				free_out.close();
+			}
+		});
+		if(cpus)
+			for(std::thread* t : { &reader, &writer })
+				pthread_setaffinity_np(t->native_handle(),
+					sizeof(*cpus), cpus);
+	}
+
+	//! write the remaining blocks and stop the threads
+	~io_threads() { stop(); }
+	void stop()
+	{
+		if(!reader.joinable())
+			return;
+		full_out.close();
+		writer.join();
+		free_in.close();
+		reader.join();
+	}
+
+	//! rethrow an error of the threads, after pop() returned nullptr
+	void rethrow()
+	{
+		stop();
+		if(read_error)
+			std::rethrow_exception(read_error);
+		if(write_error)
+			std::rethrow_exception(write_error);
+	}
+};
+
+//! the plugins of a chain, connected in a graph, which can render one
+//! file after another
+class chain_renderer
+{
+	graph g;
+	long rate;
+	render_options options;
+	std::vector<graph::node_id> nodes;
+	std::vector<float*> inputs;
+	std::vector<const float*> outputs;
+	bool used = false;
+
+public:
+	//! instantiate the plugins of @p chain for files with samplerate
+	//! @p samplerate
+	chain_renderer(const std::vector<const spa::descriptor*>& chain,
+		const render_options& options, long samplerate) :
+		g(options.block, samplerate), rate(samplerate),
+		options(options)
+	{
+		if(chain.empty())
+			throw spa::exception("no plugins to render with");
+		for(const spa::descriptor* desc : chain)
+		{
+			const graph::node_id n = g.add(*desc);
+			if(!nodes.empty())
+				g.connect(nodes.back(), options.out_port,
+					n, options.in_port);
+			nodes.push_back(n);
+		}
+		g.compile();
+
+		inputs.resize(g.channels(nodes.front(), options.in_port));
+		for(unsigned c = 0; c < inputs.size(); ++c)
+			inputs[c] = g.input(nodes.front(), options.in_port, c);
+		outputs.resize(g.channels(nodes.back(), options.out_port));
+		for(unsigned c = 0; c < outputs.size(); ++c)
+			outputs[c] = g.output(nodes.back(), options.out_port,
+				c);
+	}
+
+	long samplerate() const { return rate; }
+
+	//! render @p in into the file @p out_path
+	//! @param start when the job started, for render_stats::seconds
+	//! @param io_cpus see io_threads
+	render_stats run(wav_reader& in, const std::string& out_path,
+		const std::vector<automation_event>& automation,
+		std::chrono::steady_clock::time_point start,
+		const cpu_set_t* io_cpus = nullptr);
+};
+
+render_stats chain_renderer::run(wav_reader& in, const std::string& out_path,
+	const std::vector<automation_event>& automation,
+	std::chrono::steady_clock::time_point start, const cpu_set_t* io_cpus)
+{
+	using clock = std::chrono::steady_clock;
+	if(in.samplerate() != rate)
+		throw spa::exception("input file has a wrong samplerate");
+	if(in.channels() != inputs.size() && in.channels() != 1)
+		throw spa::exception("input file has a wrong channel count");
+	if(!std::is_sorted(automation.begin(), automation.end(),
+		[](const automation_event& a, const automation_event& b) {
+			return a.frame < b.frame; }))
+		throw spa::exception("automation is not sorted");
+
+	// in frames of this file
+	const std::uint64_t tail = options.tail_seconds > 0
+		? std::llround(options.tail_seconds * rate) : 0;
+
+	std::vector<spa::audio::osc_ringbuffer*> rings;
+	for(const automation_event& ev : automation)
+	{
+		if(ev.node >= nodes.size())
+			throw spa::exception("automation for invalid plugin");
+		if(ev.frame >= in.frames() + tail)
+			throw spa::exception("automation after the end");
+		rings.push_back(&g.osc(nodes[ev.node], ev.port.c_str()));
+	}
+
+	// the previous file must not leak into this one
+	if(used)
+		g.reset();
+	used = true;
+
+	// files
+	render_stats stats;
+	stats.channels = outputs.size();
+	wav_writer out(out_path, outputs.size(), rate, options.format);
+	io_threads io(in, out, std::max(options.queue, 1u), options.block,
+		outputs.size(), io_cpus);
+
+	std::size_t next_event = 0;
+	clock::duration wait(0);
+	auto pop = [&](block_queue& q) {
+		const clock::time_point before = clock::now();
+		block* b = q.pop();
+		wait += clock::now() - before;
+		if(!b)
+			io.rethrow();
+		return b;
+	};
+
+	//! process @p frames frames, with the input from @p src, or silence
+	//! if it is nullptr
+	auto process = [&](const float* src, std::size_t frames)
+	{
+		// plugins without tail can be skipped in the silent tail
+		g.set_input_signal(nodes.front(), options.in_port, src
+			? spa::audio::signal_t::normal
+			: spa::audio::signal_t::silent);
+		block* ob = pop(io.free_out);
+		for(std::size_t done = 0; done < frames; )
+		{
+			// send the events that are due now, and stop before
+			// the next one
+			const std::uint64_t now = stats.frames + done;
+			for(; next_event < automation.size() &&
+				automation[next_event].frame <= now;
+				++next_event)
+			{
+				const automation_event& ev =
+					automation[next_event];
+				const std::string& msg = ev.msg;
+				spa::audio::osc_ringbuffer* rb =
+					rings[next_event];
+				if(!rb->write_with_length(msg.data(),
+					msg.size()))
+				{
+					// more automation at once than fits
+					spa::audio::osc_ringbuffer* grown =
+						&g.resize_osc(nodes[ev.node],
+						ev.port.c_str(),
+						2 * rb->get_size() +
+						msg.size() + 4);
+					std::replace(rings.begin(),
+						rings.end(), rb, grown);
+					grown->write_with_length(msg.data(),
+						msg.size());
+				}
+			}
+			std::size_t len = frames - done;
+			if(next_event < automation.size())
+				len = std::min<std::uint64_t>(len,
+					automation[next_event].frame - now);
+
+			if(src)
+			{
+				const float* cur = src + done * in.channels();
+				spa::audio::deinterleave(cur, inputs.data(),
+					in.channels(), len);
+				// mono input for all channels
+				for(unsigned c = in.channels();
+					c < inputs.size(); ++c)
+					spa::audio::copy(inputs[0], inputs[c],
+						len);
+			}
+			g.process(len);
+			spa::audio::interleave(outputs.data(),
+				ob->samples.data() + done * outputs.size(),
+				outputs.size(), len);
+			done += len;
+		}
+		ob->frames = frames;
+		stats.frames += frames;
+		io.full_out.push(ob);
+	};
+
+	for(;;)
+	{
+		block* ib = pop(io.full_in);
+		if(!ib->frames)
+			break;
+		process(ib->samples.data(), ib->frames);
+		io.free_in.push(ib);
+	}
+
+	// the tail, with silent input
+	for(float* buf : inputs)
+		spa::audio::clear(buf, options.block);
+	for(std::uint64_t left = tail; left; )
+	{
+		const std::size_t frames =
+			std::min<std::uint64_t>(left, options.block);
+		process(nullptr, frames);
+		left -= frames;
+	}
+
+	io.rethrow();
+	out.close();
+	// the input file was shorter than its header said
+	if(next_event < automation.size())
+		throw spa::exception("automation after the end");
+	stats.io_wait = std::chrono::duration<double>(wait).count();
+	stats.seconds = std::chrono::duration<double>(
+		clock::now() - start).count();
+	return stats;
+}
+
+}
+
+render_stats render(const std::vector<const spa::descriptor*>& chain,
+	const std::string& in_path, const std::string& out_path,
+	const std::vector<automation_event>& automation,
+	const render_options& options)
+{
+	const std::chrono::steady_clock::time_point start =
+		std::chrono::steady_clock::now();
+	wav_reader in(in_path);
+	chain_renderer renderer(chain, options, in.samplerate());
+	return renderer.run(in, out_path, automation, start);
+}
+
+/*
+	render farm
+*/
+
+namespace {
+
+//! the CPUs in @p set
+std::vector<int> cpu_list(const cpu_set_t& set)
+{
+	std::vector<int> res;
+	for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+		if(CPU_ISSET(cpu, &set))
+			res.push_back(cpu);
+	return res;
+}
+
+}
+
+farm_stats render_farm(const std::vector<const spa::descriptor*>& chain,
+	std::vector<render_job>& jobs,
+	const std::vector<automation_event>& automation,
+	const render_options& options, const farm_options& farm)
+{
+	using clock = std::chrono::steady_clock;
+	const clock::time_point start = clock::now();
+	// the CPUs that this process may run on
+	cpu_set_t process_cpus;
+	CPU_ZERO(&process_cpus);
+	const std::vector<int> cpus =
+		sched_getaffinity(0, sizeof(process_cpus), &process_cpus)
+		? std::vector<int>() : cpu_list(process_cpus);
+	const bool pin = farm.pin && !cpus.empty();
+
+	farm_stats stats;
+	stats.workers = farm.workers ? farm.workers
+		: std::max<std::size_t>(1, cpus.size());
+	stats.workers = std::min<std::size_t>(stats.workers, jobs.size());
+
+	// the jobs are handed out one by one, so long files do not leave
+	// other workers idle
+	std::atomic<std::size_t> next(0);
+	auto worker_main = [&](unsigned worker)
+	{
+		if(pin)
+		{
+			cpu_set_t set;
+			CPU_ZERO(&set);
+			CPU_SET(cpus[worker % cpus.size()], &set);
+			// may fail, e.g. in containers, then just run unpinned
+			pthread_setaffinity_np(pthread_self(), sizeof(set),
+				&set);
+		}
+		// the plugins are only instantiated again if the samplerate
+		// changes, or after an error
+		std::unique_ptr<chain_renderer> renderer;
+		for(std::size_t i; (i = next.fetch_add(1)) < jobs.size(); )
+		{
+			render_job& job = jobs[i];
+			const clock::time_point job_start = clock::now();
+			try {
+				wav_reader in(job.in);
+				if(!renderer || renderer->samplerate()
+					!= in.samplerate())
+				{
+					renderer.reset();
+					renderer.reset(new chain_renderer(chain,
+						options, in.samplerate()));
+				}
+				// only processing is pinned, reading and
+				// writing may use any CPU
+				job.stats = renderer->run(in, job.out,
+					automation, job_start,
+					pin ? &process_cpus : nullptr);
+			} catch(const spa::exception& e) {
+				job.error = e.what();
+				renderer.reset();
+			} catch(const std::exception& e) {
+				job.error = e.what();
+				renderer.reset();
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(stats.workers);
+	for(unsigned i = 0; i < stats.workers; ++i)
+		threads.emplace_back(worker_main, i);
+	for(std::thread& t : threads)
+		t.join();
+
+	for(const render_job& job : jobs)
+	{
+		if(!job.error.empty())
+			++stats.failed;
+		stats.frames += job.stats.frames;
+		stats.samples += job.stats.frames * job.stats.channels;
+	}
+	stats.seconds = std::chrono::duration<double>(
+		clock::now() - start).count();
+	return stats;
+}
+
+/*
+	plugin_library
+*/
+
+plugin_library::plugin_library(const std::string& path,
+	unsigned long index) :
+	lib(dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL))
+{
+	if(!lib)
+		throw spa::exception("can not load library");
+	try
+	{
+		spa::descriptor_loader_t descriptor_loader;
+		// for the syntax, see the dlopen(3) manpage
+		*(void **) (&descriptor_loader) =
+			dlsym(lib, spa::descriptor_name);
+		if(!descriptor_loader)
+			throw spa::exception("library has no spa descriptor");
+		desc = (*descriptor_loader)(index);
+		if(!desc)
+			throw spa::exception("no plugin with that index");
+		spa::assert_versions_match(*desc);
+	} catch(...) {
+		delete desc;
+		dlclose(lib);
+		throw;
+	}
+}
+
+plugin_library::~plugin_library()
+{
+	delete desc;
+	dlclose(lib);
+}
+
+} // namespace host
+} // namespace spa
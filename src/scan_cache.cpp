@@ -0,0 +1,395 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <spa/scan_cache.h>
+
+namespace spa {
+namespace host {
+
+namespace {
+
+//! first bytes of each index file
+constexpr char magic[8] = { 'S', 'P', 'A', 'S', 'C', 'A', 'N', '\0' };
+//! increase on each change of the file format below
+constexpr std::uint32_t format_version = 2;
+//! stop scanning libraries whose loader never returns nullptr
+constexpr unsigned long max_plugins = 1 << 16;
+
+std::uint32_t pack(const struct spa::descriptor::properties& p)
+{
+	return p.realtime_dependency | p.hard_rt_capable << 1 |
+		p.in_place << 2 | p.no_tail << 3;
+}
+
+struct spa::descriptor::properties unpack(std::uint32_t bits)
+{
+	struct spa::descriptor::properties p = {};
+	p.realtime_dependency = bits & 1;
+	p.hard_rt_capable = bits >> 1 & 1;
+	p.in_place = bits >> 2 & 1;
+	p.no_tail = bits >> 3 & 1;
+	return p;
+}
+
+//! appends values in native byte order, since the index is only read
+//! on the machine that wrote it
+class writer
+{
+	std::string& buf;
+public:
+	explicit writer(std::string& buf) : buf(buf) {}
+	template<class T>
+	void num(T value) {
+		buf.append(reinterpret_cast<const char*>(&value), sizeof(T)); }
+	void str(const std::string& s) {
+		num<std::uint32_t>(s.size());
+		buf.append(s);
+	}
+};
+
+//! reads what writer wrote, failing on truncated or corrupt data
+class reader
+{
+	const char *cur, *end;
+public:
+	struct corrupt {};
+	reader(const char* begin, const char* end) : cur(begin), end(end) {}
+	void bytes(void* dst, std::size_t n)
+	{
+		if(static_cast<std::size_t>(end - cur) < n)
+			throw corrupt();
+		std::memcpy(dst, cur, n);
+		cur += n;
+	}
+	template<class T>
+	T num() {
+		T value;
+		bytes(&value, sizeof(T));
+		return value;
+	}
+	//! number of elements that follow, each at least one byte large
+	std::uint32_t count()
+	{
+		const std::uint32_t n = num<std::uint32_t>();
+		if(static_cast<std::size_t>(end - cur) < n)
+			throw corrupt();
+		return n;
+	}
+	std::string str()
+	{
+		const std::uint32_t n = num<std::uint32_t>();
+		if(static_cast<std::size_t>(end - cur) < n)
+			throw corrupt();
+		std::string s(cur, n);
+		cur += n;
+		return s;
+	}
+	bool done() const { return cur == end; }
+	const char* pos() const { return cur; }
+};
+
+void write(writer& w, const library_info& lib)
+{
+	w.str(lib.path);
+	w.num(lib.size);
+	w.num(lib.mtime);
+	w.str(lib.error);
+	w.num<std::uint32_t>(lib.plugins.size());
+	for(const plugin_info& p : lib.plugins)
+	{
+		w.num<std::uint64_t>(p.index);
+		w.num(p.id);
+		w.str(p.unique_name);
+		w.str(p.name);
+		w.num<std::uint32_t>(p.port_names.size());
+		for(const std::string& port : p.port_names)
+			w.str(port);
+		w.num<std::uint32_t>(static_cast<std::uint32_t>(p.license));
+		w.num(pack(p.properties));
+	}
+}
+
+library_info read(reader& r)
+{
+	library_info lib;
+	lib.path = r.str();
+	lib.size = r.num<std::uint64_t>();
+	lib.mtime = r.num<std::int64_t>();
+	lib.error = r.str();
+	lib.plugins.resize(r.count());
+	for(plugin_info& p : lib.plugins)
+	{
+		p.index = r.num<std::uint64_t>();
+		p.id = r.num<std::uint64_t>();
+		p.unique_name = r.str();
+		p.name = r.str();
+		p.port_names.resize(r.count());
+		for(std::string& port : p.port_names)
+			port = r.str();
+		p.license = static_cast<spa::descriptor::license_type>(
+			r.num<std::uint32_t>());
+		p.properties = unpack(r.num<std::uint32_t>());
+	}
+	return lib;
+}
+
+}
+
+bool stat_file(const std::string& path, std::uint64_t& size,
+	std::int64_t& mtime)
+{
+	struct stat st;
+	if(stat(path.c_str(), &st))
+		return false;
+	size = st.st_size;
+	mtime = std::int64_t(st.st_mtim.tv_sec) * 1000000000 +
+		st.st_mtim.tv_nsec;
+	return true;
+}
+
+void serialize(const library_info& info, std::string& buf)
+{
+	writer w(buf);
+	write(w, info);
+}
+
+bool deserialize(const char*& cur, const char* end, library_info& info)
+{
+	try
+	{
+		reader r(cur, end);
+		info = read(r);
+		cur = r.pos();
+		return true;
+	} catch(reader::corrupt& ) {
+		return false;
+	}
+}
+
+library_info scan_library(const std::string& path)
+{
+	library_info info;
+	info.path = path;
+	if(!stat_file(path, info.size, info.mtime))
+	{
+		info.error = "can not access file";
+		return info;
+	}
+
+	void* lib = dlopen(path.c_str(), RTLD_LAZY | RTLD_LOCAL);
+	if(!lib)
+	{
+		info.error = dlerror();
+		return info;
+	}
+
+	spa::descriptor_loader_t descriptor_loader;
+	// for the syntax, see the dlopen(3) manpage
+	*(void **) (&descriptor_loader) = dlsym(lib, spa::descriptor_name);
+	// the library only counts as broken if none of its plugins works
+	std::string error = "no spa descriptor";
+	// construct one descriptor after the other, until the last one
+	for(unsigned long index = 0; descriptor_loader; ++index)
+	{
+		if(index == max_plugins)
+		{
+			error = "too many descriptors";
+			break;
+		}
+		spa::descriptor* desc = nullptr;
+		try
+		{
+			desc = (*descriptor_loader)(index);
+			if(!desc)
+				break;
+			spa::assert_versions_match(*desc);
+			plugin_info p;
+			p.index = index;
+			p.id = desc->id();
+			// a wrong precomputed ID would break savefiles
+			if(p.id != spa::plugin_id(spa::hoster_name(*desc),
+				desc->organization_url(), desc->project_url(),
+				desc->branch(), desc->label()))
+				throw spa::exception("plugin ID does not match "
+					"its identification");
+			p.unique_name = spa::unique_name(*desc);
+			p.name = desc->name();
+			const char* const* table = desc->port_name_table();
+			if(table)
+				for(; *table; ++table)
+					p.port_names.emplace_back(*table);
+			else
+				for(const spa::simple_str& port :
+					desc->port_names())
+					p.port_names.emplace_back(
+						port.data());
+			p.license = desc->license();
+			p.properties = desc->properties;
+			info.plugins.push_back(std::move(p));
+		} catch(const spa::exception& e) {
+			error = e.what();
+		} catch(const std::exception& e) {
+			error = e.what();
+		}
+		// a broken descriptor is skipped, but a broken loader ends
+		// the enumeration
+		if(!desc)
+			break;
+		delete desc;
+	}
+	if(info.plugins.empty())
+		info.error = error;
+	dlclose(lib);
+	return info;
+}
+
+scan_cache::scan_cache(std::string file, scan_fn scan) :
+	file(std::move(file)),
+	scan(scan)
+{
+	load();
+}
+
+void scan_cache::load()
+{
+	std::ifstream in(file, std::ios::binary);
+	if(!in)
+		return;
+	const std::string buf((std::istreambuf_iterator<char>(in)),
+		std::istreambuf_iterator<char>());
+
+	try
+	{
+		reader r(buf.data(), buf.data() + buf.size());
+		char m[sizeof(magic)];
+		r.bytes(m, sizeof(m));
+		// libraries must be scanned again if the host's spa version
+		// changed, since they may be (in)compatible now
+		if(std::memcmp(m, magic, sizeof(magic)) ||
+			r.num<std::uint32_t>() != format_version ||
+			r.num<std::uint32_t>() != spa::api_version.major() ||
+			r.num<std::uint32_t>() != spa::api_version.minor() ||
+			r.num<std::uint32_t>() != spa::api_version.patch())
+			throw reader::corrupt();
+		for(std::uint32_t n = r.num<std::uint32_t>(); n; --n)
+		{
+			library_info lib = read(r);
+			std::string path = lib.path;
+			libs.emplace(std::move(path), std::move(lib));
+		}
+		if(!r.done())
+			throw reader::corrupt();
+	} catch(reader::corrupt& ) {
+		libs.clear();
+		dirty = true;
+	}
+}
+
+bool scan_cache::current(const library_info& info, bool& exists)
+{
+	std::uint64_t size;
+	std::int64_t mtime;
+	exists = stat_file(info.path, size, mtime);
+	return exists && size == info.size && mtime == info.mtime;
+}
+
+const library_info& scan_cache::lookup(const std::string& path)
+{
+	auto itr = libs.find(path);
+	bool exists = true;
+	if(itr != libs.end() && current(itr->second, exists))
+		return itr->second;
+	if(itr == libs.end() && access(path.c_str(), F_OK))
+		exists = false;
+	if(!exists)
+		throw spa::exception("library does not exist");
+
+	library_info info = scan(path);
+	info.path = path;
+	dirty = true;
+	if(itr == libs.end())
+		itr = libs.emplace(path, std::move(info)).first;
+	else
+		itr->second = std::move(info);
+	return itr->second;
+}
+
+std::vector<std::string> scan_cache::stale(
+	const std::vector<std::string>& paths)
+{
+	std::vector<std::string> res;
+	for(const std::string& path : paths)
+	{
+		auto itr = libs.find(path);
+		bool exists = true;
+		if(itr == libs.end() || !current(itr->second, exists))
+			res.push_back(path);
+	}
+	return res;
+}
+
+void scan_cache::insert(library_info info)
+{
+	std::string path = info.path;
+	libs[std::move(path)] = std::move(info);
+	dirty = true;
+}
+
+void scan_cache::prune()
+{
+	for(auto itr = libs.begin(); itr != libs.end(); )
+	{
+		bool exists;
+		current(itr->second, exists);
+		if(exists)
+			++itr;
+		else
+		{
+			itr = libs.erase(itr);
+			dirty = true;
+		}
+	}
+}
+
+void scan_cache::save()
+{
+	if(!dirty)
+		return;
+
+	std::string buf;
+	writer w(buf);
+	buf.append(magic, sizeof(magic));
+	w.num(format_version);
+	w.num<std::uint32_t>(spa::api_version.major());
+	w.num<std::uint32_t>(spa::api_version.minor());
+	w.num<std::uint32_t>(spa::api_version.patch());
+	w.num<std::uint32_t>(libs.size());
+	for(const auto& pr : libs)
+		write(w, pr.second);
+
+	// write a temporary file and rename it, which is atomic
+	const std::string tmp = file + ".tmp." + std::to_string(getpid());
+	{
+		std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+		out.write(buf.data(), buf.size());
+		if(!out.flush())
+		{
+			std::remove(tmp.c_str());
+			throw spa::exception("can not write scan cache");
+		}
+	}
+	if(std::rename(tmp.c_str(), file.c_str()))
+	{
+		std::remove(tmp.c_str());
+		throw spa::exception("can not write scan cache");
+	}
+	dirty = false;
+}
+
+} // namespace host
+} // namespace spa
@@ -0,0 +1,299 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <spa/scanner.h>
+
+namespace spa {
+namespace host {
+
+namespace {
+
+using std::chrono::steady_clock;
+
+//! send all of @p size bytes, or return false if the other side is gone
+bool send_all(int fd, const char* data, std::size_t size)
+{
+	while(size)
+	{
+		// no SIGPIPE if a worker has crashed
+		const ssize_t n = send(fd, data, size, MSG_NOSIGNAL);
+		if(n < 0 && errno == EINTR)
+			continue;
+		if(n <= 0)
+			return false;
+		data += n;
+		size -= n;
+	}
+	return true;
+}
+
+bool recv_all(int fd, char* data, std::size_t size)
+{
+	while(size)
+	{
+		const ssize_t n = recv(fd, data, size, 0);
+		if(n < 0 && errno == EINTR)
+			continue;
+		if(n <= 0)
+			return false;
+		data += n;
+		size -= n;
+	}
+	return true;
+}
+
+// each message is its size, followed by its data
+
+bool send_msg(int fd, const std::string& msg)
+{
+	const std::uint32_t size = msg.size();
+	return send_all(fd, reinterpret_cast<const char*>(&size),
+		sizeof(size)) && send_all(fd, msg.data(), msg.size());
+}
+
+bool recv_msg(int fd, std::string& msg)
+{
+	std::uint32_t size;
+	if(!recv_all(fd, reinterpret_cast<char*>(&size), sizeof(size)))
+		return false;
+	msg.resize(size);
+	return recv_all(fd, &msg[0], size);
+}
+
+//! main loop of the worker processes, until the host closes @p fd
+[[noreturn]] void worker_main(int fd)
+{
+	std::string path, reply;
+	while(recv_msg(fd, path))
+	{
+		reply.clear();
+		serialize(scan_library(path), reply);
+		if(!send_msg(fd, reply))
+			break;
+	}
+	// skip the host's atexit handlers and destructors
+	_exit(0);
+}
+
+struct worker
+{
+	pid_t pid = -1;
+	int fd = -1; //!< socket to the worker, or -1 if not running
+	bool busy = false;
+	std::size_t job = 0; //!< index of the library that it scans
+	steady_clock::time_point deadline;
+	std::string reply; //!< reply received so far
+};
+
+//! the workers, which are stopped when it goes out of scope
+class pool
+{
+	std::vector<worker> workers;
+public:
+	explicit pool(std::size_t size) : workers(size) {}
+	~pool()
+	{
+		// closing the sockets lets idle workers exit
+		for(worker& w : workers)
+			if(w.fd >= 0)
+			{
+				if(w.busy)
+					kill(w.pid, SIGKILL);
+				close(w.fd);
+			}
+		for(worker& w : workers)
+			if(w.fd >= 0)
+				waitpid(w.pid, nullptr, 0);
+	}
+	std::vector<worker>& get() { return workers; }
+
+	void start(worker& w)
+	{
+		int sv[2];
+		if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv))
+			throw spa::exception("can not create socket");
+		const pid_t pid = fork();
+		if(pid < 0)
+		{
+			close(sv[0]);
+			close(sv[1]);
+			throw spa::exception("can not fork scanner");
+		}
+		if(!pid)
+		{
+			// only keep our own socket
+			for(const worker& other : workers)
+				if(other.fd >= 0)
+					close(other.fd);
+			close(sv[0]);
+			try {
+				worker_main(sv[1]);
+			} catch(...) {
+				// never return into the host's code
+				_exit(EXIT_FAILURE);
+			}
+		}
+		close(sv[1]);
+		w.pid = pid;
+		w.fd = sv[0];
+	}
+
+	//! kill the worker after it crashed or hung
+	//! @return a description of what happened to it
+	std::string stop(worker& w)
+	{
+		kill(w.pid, SIGKILL);
+		close(w.fd);
+		w.fd = -1;
+		w.busy = false;
+		int status = 0;
+		waitpid(w.pid, &status, 0);
+		if(WIFSIGNALED(status) && WTERMSIG(status) != SIGKILL)
+			return std::string("crashed: ") +
+				strsignal(WTERMSIG(status));
+		if(WIFEXITED(status))
+			return "exited with status " +
+				std::to_string(WEXITSTATUS(status));
+		return "killed";
+	}
+};
+
+//! result for a library that could not be scanned
+library_info failure(const std::string& path, std::string error)
+{
+	library_info info;
+	info.path = path;
+	// remember size and mtime, so a cache does not load it again
+	stat_file(path, info.size, info.mtime);
+	info.error = std::move(error);
+	return info;
+}
+
+//! receive what is available of @p w's reply
+//! @return false if the worker is gone
+bool receive(worker& w)
+{
+	char buf[4096];
+	ssize_t n;
+	while((n = recv(w.fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0)
+		w.reply.append(buf, n);
+	return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK ||
+		errno == EINTR);
+}
+
+//! whether @p w's reply is complete, then strip its size
+bool complete(worker& w)
+{
+	std::uint32_t size;
+	if(w.reply.size() < sizeof(size))
+		return false;
+	std::memcpy(&size, w.reply.data(), sizeof(size));
+	if(w.reply.size() < sizeof(size) + size)
+		return false;
+	w.reply.erase(0, sizeof(size));
+	return true;
+}
+
+}
+
+scanner::scanner(unsigned jobs, unsigned timeout_ms) :
+	max_jobs(jobs ? jobs
+		: std::max(1u, std::thread::hardware_concurrency())),
+	timeout_ms(timeout_ms)
+{
+}
+
+std::vector<library_info> scanner::scan(const std::vector<std::string>& paths)
+{
+	std::vector<library_info> results(paths.size());
+	std::size_t next = 0, left = paths.size();
+	pool p(std::min<std::size_t>(max_jobs, paths.size()));
+	std::vector<pollfd> fds;
+	const std::chrono::milliseconds timeout(timeout_ms);
+
+	while(left)
+	{
+		const steady_clock::time_point now = steady_clock::now();
+		for(worker& w : p.get())
+		{
+			if(w.busy || next == paths.size())
+				continue;
+			if(w.fd < 0)
+				p.start(w);
+			w.busy = true;
+			w.job = next++;
+			w.deadline = now + timeout;
+			w.reply.clear();
+			if(!send_msg(w.fd, paths[w.job]))
+			{
+				results[w.job] = failure(paths[w.job],
+					p.stop(w));
+				--left;
+			}
+		}
+
+		// wait until the first worker replies or times out
+		fds.clear();
+		steady_clock::time_point deadline =
+			steady_clock::time_point::max();
+		for(const worker& w : p.get())
+			if(w.busy)
+			{
+				fds.push_back({ w.fd, POLLIN, 0 });
+				deadline = std::min(deadline, w.deadline);
+			}
+		if(fds.empty())
+			continue;
+		const long wait = std::chrono::duration_cast<
+			std::chrono::milliseconds>(deadline - now).count();
+		if(poll(fds.data(), fds.size(), std::max(wait, 0L) + 1) < 0 &&
+			errno != EINTR)
+			throw spa::exception("can not wait for scanners");
+
+		const steady_clock::time_point after = steady_clock::now();
+		for(worker& w : p.get())
+		{
+			if(!w.busy)
+				continue;
+			const std::string& path = paths[w.job];
+			if(!receive(w))
+			{
+				// the library crashed the worker
+				results[w.job] = failure(path, p.stop(w));
+				--left;
+			}
+			else if(complete(w))
+			{
+				library_info& info = results[w.job];
+				const char* cur = w.reply.data(),
+					* end = cur + w.reply.size();
+				if(!deserialize(cur, end, info))
+					info = failure(path, "invalid reply");
+				info.path = path;
+				w.busy = false;
+				--left;
+			}
+			else if(after >= w.deadline)
+			{
+				p.stop(w);
+				results[w.job] = failure(path, "timed out");
+				--left;
+			}
+		}
+	}
+
+	return results;
+}
+
+} // namespace host
+} // namespace spa
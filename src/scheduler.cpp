@@ -0,0 +1,247 @@
+#include <climits>
+#include <pthread.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <spa/scheduler.h>
+
+namespace spa {
+namespace host {
+
+namespace {
+
+//! number of times an idle worker checks for a new run() before sleeping
+constexpr unsigned spin_count = 20000;
+//! number of failed steal attempts before a thread yields its CPU, in
+//! case the thread that works on the remaining tasks was preempted
+constexpr unsigned steal_count = 256;
+
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+	__builtin_ia32_pause();
+#endif
+}
+
+void futex_wait(std::atomic<int>& word, int expected)
+{
+	syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAIT_PRIVATE,
+		expected, nullptr, nullptr, 0);
+}
+
+void futex_wake_all(std::atomic<int>& word)
+{
+	syscall(SYS_futex, reinterpret_cast<int*>(&word), FUTEX_WAKE_PRIVATE,
+		INT_MAX, nullptr, nullptr, 0);
+}
+
+}
+
+/*
+	deque
+*/
+
+void scheduler::deque::resize(std::size_t capacity)
+{
+	std::size_t size = 1;
+	while(size < capacity)
+		size *= 2;
+	items.reset(new std::atomic<unsigned>[size]);
+	mask = static_cast<long>(size) - 1;
+	top.store(0);
+	bottom.store(0);
+}
+
+void scheduler::deque::push(unsigned task)
+{
+	const long b = bottom.load(std::memory_order_relaxed);
+	items[b & mask].store(task, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+bool scheduler::deque::pop(unsigned& task)
+{
+	const long b = bottom.load(std::memory_order_relaxed) - 1;
+	bottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	long t = top.load(std::memory_order_relaxed);
+	bool res = t <= b;
+	if(res)
+	{
+		task = items[b & mask].load(std::memory_order_relaxed);
+		if(t == b)
+		{
+			// last item, race against thieves
+			res = top.compare_exchange_strong(t, t + 1,
+				std::memory_order_seq_cst,
+				std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+	}
+	else
+		bottom.store(b + 1, std::memory_order_relaxed);
+	return res;
+}
+
+bool scheduler::deque::steal(unsigned& task)
+{
+	long t = top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const long b = bottom.load(std::memory_order_acquire);
+	if(t < b)
+	{
+		task = items[t & mask].load(std::memory_order_relaxed);
+		return top.compare_exchange_strong(t, t + 1,
+			std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+	return false;
+}
+
+/*
+	scheduler
+*/
+
+scheduler::scheduler(unsigned workers) :
+	remaining(0),
+	deques(new deque[workers + 1]),
+	epoch(0), parked(0), busy(0), stop(false)
+{
+	int policy;
+	sched_param param;
+	pthread_getschedparam(pthread_self(), &policy, &param);
+
+	threads.reserve(workers);
+	for(unsigned i = 0; i < workers; ++i)
+	{
+		threads.emplace_back(&scheduler::worker_main, this, i);
+		// may fail without permissions, then just keep the default
+		pthread_setschedparam(threads.back().native_handle(),
+			policy, &param);
+	}
+}
+
+scheduler::~scheduler()
+{
+	stop.store(true);
+	epoch.fetch_add(1);
+	futex_wake_all(epoch);
+	for(std::thread& t : threads)
+		t.join();
+}
+
+void scheduler::prepare(const std::vector<std::vector<unsigned>>& successors)
+{
+	task_count = successors.size();
+	deps.assign(task_count, 0);
+	succ_begin.clear();
+	succ.clear();
+	for(const std::vector<unsigned>& s : successors)
+	{
+		succ_begin.push_back(succ.size());
+		for(unsigned next : s)
+		{
+			succ.push_back(next);
+			++deps[next];
+		}
+	}
+	succ_begin.push_back(succ.size());
+
+	// workers may still be looking for tasks of the last run()
+	while(busy.load())
+		std::this_thread::yield();
+
+	pending.reset(new std::atomic<unsigned>[task_count]);
+	for(unsigned i = 0; i <= threads.size(); ++i)
+		deques[i].resize(task_count);
+}
+
+void scheduler::execute(unsigned self, unsigned task)
+{
+	fn(ctx, task);
+	for(unsigned i = succ_begin[task]; i < succ_begin[task + 1]; ++i)
+		if(pending[succ[i]].fetch_sub(1, std::memory_order_acq_rel)
+			== 1)
+			deques[self].push(succ[i]);
+	// must be the last access to the task graph
+	remaining.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void scheduler::work(unsigned self)
+{
+	const unsigned count = threads.size() + 1;
+	unsigned task, failed = 0;
+	while(remaining.load())
+	{
+		bool found = deques[self].pop(task);
+		for(unsigned i = 1; !found && i < count; ++i)
+			found = deques[(self + i) % count].steal(task);
+		if(found)
+		{
+			execute(self, task);
+			failed = 0;
+		}
+		else if(++failed < steal_count)
+			cpu_relax();
+		else
+			std::this_thread::yield();
+	}
+}
+
+void scheduler::run(task_fn f, void* c)
+{
+	if(!task_count)
+		return;
+	fn = f;
+	ctx = c;
+	for(unsigned i = 0; i < task_count; ++i)
+		pending[i].store(deps[i], std::memory_order_relaxed);
+
+	const unsigned self = threads.size();
+	for(unsigned i = 0; i < task_count; ++i)
+		if(!deps[i])
+			deques[self].push(i);
+	remaining.store(task_count);
+
+	// wake up the workers
+	epoch.fetch_add(1);
+	if(parked.load())
+		futex_wake_all(epoch);
+
+	// workers that are still looking for tasks when this returns do
+	// no harm, since the deques are empty until the next run()
+	work(self);
+}
+
+void scheduler::worker_main(unsigned self)
+{
+	// not epoch.load(), since this thread may start late
+	int seen = 0;
+	for(;;)
+	{
+		// wait for the next run()
+		for(unsigned spins = 0; epoch.load() == seen; ++spins)
+		{
+			if(spins < spin_count)
+				cpu_relax();
+			else
+			{
+				parked.fetch_add(1);
+				futex_wait(epoch, seen);
+				parked.fetch_sub(1);
+			}
+		}
+		seen = epoch.load();
+		if(stop.load())
+			return;
+
+		busy.fetch_add(1);
+		work(self);
+		busy.fetch_sub(1);
+	}
+}
+
+} // namespace host
+} // namespace spa
+
@@ -12,11 +12,33 @@ port_ref_base::~port_ref_base() {}
 plugin::~plugin() {}
 descriptor::~descriptor() {}
 
+/*
+ * descriptor defaults
+ */
+
+std::uint64_t descriptor::id() const
+{
+	return plugin_id(hoster_name(*this), organization_url(),
+		project_url(), branch(), label());
+}
+
+simple_vec<simple_str> descriptor::port_names() const
+{
+	const char* const* table = port_name_table();
+	unsigned count = 0;
+	for(; table && table[count]; ++count) ;
+	simple_vec<simple_str> res = simple_vec<simple_str>::with_size(count);
+	for(unsigned i = 0; i < count; ++i)
+		res[i] = table[i];
+	return res;
+}
+
 /*
  * accept definitions
  */
 
 ACCEPT(port_ref_base, spa::visitor)
+ACCEPT(blob_return_out, spa::visitor)
 
 }
 
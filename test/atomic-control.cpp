@@ -0,0 +1,58 @@
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <thread>
+#include <spa/audio.h>
+
+template<class T1, class T2>
+void assert_eq(const T1& exp, const T2& cur)
+{
+	if(exp != cur)
+	{
+		std::cerr << "Expected " << exp << " got " << cur << std::endl;
+		assert(exp == cur);
+	}
+}
+
+//! copies its control value, like a plugin would use it in run()
+class reader : public spa::plugin
+{
+public:
+	spa::audio::atomic_control_in<float> level;
+	float last = 0.0f;
+
+	void run() override { last = level; }
+	spa::port_ref_base& port(const char* ) override { return level; }
+};
+
+int main()
+{
+	std::atomic<float> value(0.0f);
+	reader plugin;
+	plugin.level.set_ref(&value);
+
+	plugin.level.set(0.5f);
+	plugin.run();
+	assert_eq(0.5f, plugin.last);
+
+	// a UI thread increases the value, the plugin must see the values in
+	// order, and finally the last one
+	constexpr int last = 10000;
+	std::thread ui([&]{
+		for(int i = 1; i <= last; ++i)
+			value.store(static_cast<float>(i),
+				std::memory_order_release);
+	});
+	float prev = 0.0f;
+	do
+	{
+		plugin.run();
+		assert(plugin.last == 0.5f || plugin.last >= prev);
+		if(plugin.last != 0.5f)
+			prev = plugin.last;
+	} while(plugin.last != last);
+	ui.join();
+	assert_eq(static_cast<float>(last), plugin.level.get());
+
+	return 0;
+}
@@ -0,0 +1,176 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <spa/audio.h>
+#include <spa/audio_dsp.h>
+
+template<class T1, class T2>
+void assert_eq(const T1& exp, const T2& cur)
+{
+	if(exp != cur)
+	{
+		std::cerr << "Expected " << exp << " got " << cur << std::endl;
+		assert(exp == cur);
+	}
+}
+
+void check_kernels()
+{
+	using namespace spa::audio;
+
+	// odd sizes, to test the remainders after the vector loops
+	constexpr std::size_t n = 37;
+	float src[n], dst[n], l[n], r[n];
+	for(std::size_t i = 0; i < n; ++i)
+		src[i] = (i % 2 ? -1.0f : 1.0f) * static_cast<float>(i) / n;
+
+	gain(src, dst, 2.0f, n);
+	for(std::size_t i = 0; i < n; ++i)
+		assert_eq(src[i] * 2.0f, dst[i]);
+	mix(src, dst, n);
+	for(std::size_t i = 0; i < n; ++i)
+		assert_eq(src[i] * 3.0f, dst[i]);
+	mix_gain(src, dst, -3.0f, n);
+	for(std::size_t i = 0; i < n; ++i)
+		assert(std::fabs(dst[i]) < 1e-6f); // FMA may round differently
+
+	copy(src, dst, n);
+	gain_ramp(dst, dst, 1.0f, 0.5f, n); // in place
+	for(std::size_t i = 0; i < n; ++i)
+		assert_eq(src[i] * (1.0f + 0.5f * i), dst[i]);
+
+	clear(dst, n);
+	for(std::size_t i = 0; i < n; ++i)
+		assert_eq(0.0f, dst[i]);
+
+	assert_eq(36.0f / n, peak(src, n));
+	float sum = 0.0f;
+	for(std::size_t i = 0; i < n; ++i)
+		sum += src[i] * src[i];
+	assert(std::fabs(rms(src, n) - std::sqrt(sum / n)) < 1e-6f);
+	assert_eq(0.0f, rms(src, 0));
+
+	// constant power: centered signals have -3 dB on each side
+	pan(src, l, r, 0.0f, n);
+	for(std::size_t i = 0; i < n; ++i)
+	{
+		assert(std::fabs(l[i] - r[i]) < 1e-6f);
+		assert(std::fabs(l[i] * l[i] + r[i] * r[i]
+			- src[i] * src[i]) < 1e-6f);
+	}
+	pan(src, l, r, -1.0f, n);
+	assert_eq(src[5], l[5]);
+	assert(std::fabs(r[5]) < 1e-6f);
+
+	float inter[3 * n], out0[n], out1[n], out2[n];
+	for(unsigned channels = 2; channels <= 3; ++channels)
+	{
+		const float* planar[3] = { src, l, src };
+		float* const outs[3] = { out0, out1, out2 };
+		interleave(planar, inter, channels, n);
+		assert_eq(l[4], inter[4 * channels + 1]);
+		deinterleave(inter, outs, channels, n);
+		for(std::size_t i = 0; i < n; ++i)
+		{
+			assert_eq(src[i], out0[i]);
+			assert_eq(l[i], out1[i]);
+		}
+	}
+}
+
+void check_conversion()
+{
+	using namespace spa::audio;
+
+	// integer conversion, including clipping and rounding (ties to even,
+	// so 1.5 and 0.5 LSB become 2 and 0)
+	const float in[] = { 0.0f, 0.5f, -1.0f, 2.0f, -2.0f, 3.0f / 65536.0f,
+		1.0f / 65536.0f };
+	int16_t i16[7];
+	convert(in, i16, 7);
+	const int16_t exp16[] = { 0, 16384, -32768, 32767, -32768, 2, 0 };
+	for(int i = 0; i < 7; ++i)
+		assert_eq(exp16[i], i16[i]);
+
+	int24_t i24[7];
+	int32_t i32[7];
+	float back[7];
+	convert(in, i24, 7);
+	convert(i24, back, 7);
+	assert_eq(0.5f, back[1]);
+	assert_eq(-1.0f, back[2]);
+	assert(back[3] < 1.0f && back[3] > 0.9999f);
+	convert(in, i32, 7);
+	assert_eq(2147483647, i32[3]);
+	convert(i32, back, 7);
+	assert_eq(-1.0f, back[4]);
+	assert_eq(3.0f / 65536.0f, back[5]);
+
+	convert(i16, back, 7);
+	assert_eq(0.5f, back[1]);
+
+	// dithering adds at most 1 LSB of noise
+	dither_state st;
+	const float quiet[4] = { 0.25f, 0.25f, 0.25f, 0.25f };
+	convert(quiet, i16, 4, dither_t::triangular, &st);
+	for(int i = 0; i < 4; ++i)
+		assert(std::abs(i16[i] - 8192) <= 1);
+
+	// NaN becomes the minimum, in the vector loops and the rest
+	float nan[19];
+	for(float& f : nan)
+		f = std::numeric_limits<float>::quiet_NaN();
+	int16_t n16[19];
+	int24_t n24[19];
+	int32_t n32[19];
+	float n24_back[19];
+	for(int pass = 0; pass < 2; ++pass)
+	{
+		if(pass)
+		{
+			convert(nan, n16, 19, dither_t::triangular, &st);
+			convert(nan, n24, 19, dither_t::triangular, &st);
+		}
+		else
+		{
+			convert(nan, n16, 19);
+			convert(nan, n24, 19);
+		}
+		convert(n24, n24_back, 19);
+		for(int i = 0; i < 19; ++i)
+		{
+			assert_eq(-32768, n16[i]);
+			assert_eq(-1.0f, n24_back[i]);
+		}
+	}
+	convert(nan, n32, 19);
+	for(int i = 0; i < 19; ++i)
+		assert_eq(-2147483647 - 1, n32[i]);
+
+	double d[6];
+	convert(in, d, 6);
+	convert(d, back, 6);
+	for(int i = 0; i < 6; ++i)
+		assert_eq(in[i], back[i]);
+}
+
+int main()
+{
+	using namespace spa::audio;
+
+	// all instruction sets must compute the same
+	const simd_t best = simd();
+	for(int l = 0; l <= static_cast<int>(best); ++l)
+	{
+		const simd_t level = static_cast<simd_t>(l);
+		if(set_simd(level) == level)
+		{
+			check_kernels();
+			check_conversion();
+		}
+	}
+	assert_eq(static_cast<int>(best), static_cast<int>(set_simd(best)));
+
+	return 0;
+}
@@ -0,0 +1,126 @@
+#include <cassert>
+#include <iostream>
+#include <spa/graph.h>
+
+template<class T1, class T2>
+void assert_eq(const T1& exp, const T2& cur)
+{
+	if(exp != cur)
+	{
+		std::cerr << "Expected " << exp << " got " << cur << std::endl;
+		assert(exp == cur);
+	}
+}
+
+constexpr unsigned channels = 3;
+
+//! multiplies channel c by c + 1, with either bus layout
+template<spa::audio::bus::layout_t Layout>
+class scaler : public spa::plugin
+{
+	spa::audio::samplecount samplecount;
+
+	void run() override
+	{
+		const bool planar = Layout == spa::audio::bus::layout_t::planar;
+		for(unsigned c = 0; c < channels; ++c)
+			for(unsigned i = 0; i < samplecount; ++i)
+			{
+				if(planar)
+					out.channel(c)[i] =
+						(c + 1) * in.channel(c)[i];
+				else
+					out.data[0][i * channels + c] =
+						(c + 1) *
+						in.data[0][i * channels + c];
+			}
+	}
+
+	spa::port_ref_base& port(const char* path) override
+	{
+		switch(path[0])
+		{
+			case 'i': return in;
+			case 'o': return out;
+			case 's': return samplecount;
+			default: throw spa::port_not_found(path);
+		}
+	}
+public:
+	spa::audio::bus::in in;
+	spa::audio::bus::out out;
+	scaler() : in(channels, Layout), out(channels, Layout) {}
+	void set_samplecount(unsigned* n) { samplecount.set_ref(n); }
+};
+
+template<spa::audio::bus::layout_t Layout>
+class scaler_descriptor : public spa::descriptor
+{
+	SPA_DESCRIPTOR
+public:
+	hoster_t hoster() const override { return hoster_t::localhost; }
+	const char* organization_url() const override { return "spa"; }
+	const char* project_url() const override { return "spa"; }
+	const char* label() const override { return "scaler"; }
+	const char* project() const override { return "spa"; }
+	const char* name() const override { return "scaler"; }
+	license_type license() const override {
+		return license_type::gpl_3_0; }
+	const char* const* port_name_table() const override {
+		static const char* const names[] = {
+			"in", "out", "samplecount", nullptr };
+		return names;
+	}
+	scaler<Layout>* instantiate() const override {
+		return new scaler<Layout>; }
+};
+
+int main()
+{
+	using spa::audio::bus::layout_t;
+	using spa::host::graph;
+
+	// planar, in a graph
+	{
+		scaler_descriptor<layout_t::planar> desc;
+		graph g(16);
+		const graph::node_id n = g.add(desc);
+		g.compile();
+		assert_eq(channels, g.channels(n, "in"));
+		for(unsigned c = 0; c < channels; ++c)
+			for(unsigned i = 0; i < 16; ++i)
+				g.input(n, "in", c)[i] = 0.5f;
+		g.process(16);
+		for(unsigned c = 0; c < channels; ++c)
+			for(unsigned i = 0; i < 16; ++i)
+				assert_eq(0.5f * (c + 1),
+					g.output(n, "out", c)[i]);
+	}
+
+	// interleaved, connected by hand
+	{
+		scaler<layout_t::interleaved> plugin;
+		float in[4 * channels], out[4 * channels];
+		for(unsigned i = 0; i < 4 * channels; ++i)
+			in[i] = static_cast<float>(i);
+		const float* in_table[] = { in };
+		float* out_table[] = { out };
+		plugin.in.data = in_table;
+		plugin.out.data = out_table;
+		unsigned frames = 4;
+		plugin.set_samplecount(&frames);
+		static_cast<spa::plugin&>(plugin).run();
+		for(unsigned i = 0; i < 4 * channels; ++i)
+			assert_eq(static_cast<float>(i * (i % channels + 1)),
+				out[i]);
+
+		// the graph only has planar buffers
+		scaler_descriptor<layout_t::interleaved> desc;
+		graph g(16);
+		bool thrown = false;
+		try { g.add(desc); } catch(spa::exception& ) { thrown = true; }
+		assert(thrown);
+	}
+
+	return 0;
+}
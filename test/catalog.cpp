@@ -0,0 +1,88 @@
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include <spa/catalog.h>
+
+template<class T1, class T2>
+void assert_eq(const T1& exp, const T2& cur)
+{
+	if(exp != cur)
+	{
+		std::cerr << "Expected " << exp << " got " << cur << std::endl;
+		assert(exp == cur);
+	}
+}
+
+// test vectors for hosts that compute the ID themselves
+static_assert(spa::plugin_id("github.com", "JohannesLorenz", "spa",
+	"master", "example-plugin") == 0xc61708493cfb112dull,
+	"plugin ID does not match the specification");
+static_assert(spa::plugin_id("github.com", nullptr, "spa", "master",
+	"multi-0") == spa::detail::fnv1a("github.com::spa::master::multi-0"),
+	"organization must be skipped if it is nullptr");
+
+int main()
+{
+	using spa::host::catalog;
+
+	catalog c;
+	assert_eq(0u, c.size());
+	assert(!c.find(42));
+
+	// many IDs, including some with a regular pattern
+	constexpr std::uint32_t n = 10000;
+	std::vector<std::uint64_t> ids(n);
+	std::uint64_t id = 1;
+	for(std::uint32_t i = 0; i < n; ++i)
+	{
+		id = id * 6364136223846793005ull + 1442695040888963407ull;
+		ids[i] = i % 4 ? id : std::uint64_t(i) << 20;
+		assert(c.insert(ids[i], i, i + 1));
+	}
+	assert_eq(n, c.size());
+	// replace
+	assert(!c.insert(ids[4], 7, 8));
+	assert_eq(n, c.size());
+	assert_eq(7u, c.find(ids[4])->library);
+
+	// erase every second entry, the others must still be found
+	for(std::uint32_t i = 1; i < n; i += 2)
+		assert(c.erase(ids[i]));
+	assert_eq(n / 2, c.size());
+	for(std::uint32_t i = 0; i < n; ++i)
+	{
+		const catalog::entry* e = c.find(ids[i]);
+		if(i % 2)
+			assert(!e);
+		else
+		{
+			assert(e);
+			assert_eq(ids[i], e->id);
+			assert_eq(i == 4 ? 8 : i + 1, e->index);
+		}
+	}
+	assert(!c.erase(1));
+
+	// libraries
+	c.clear();
+	spa::host::library_info lib;
+	lib.path = "/usr/lib/spa/multi.so";
+	lib.plugins.resize(3);
+	for(unsigned long i = 0; i < 3; ++i)
+	{
+		lib.plugins[i].index = i;
+		lib.plugins[i].id = 100 + i;
+	}
+	c.add(lib);
+	lib.path = "/usr/lib/spa/empty.so";
+	lib.plugins.clear();
+	c.add(lib);
+	assert_eq(3u, c.size());
+	assert_eq(1u, c.libraries().size());
+	const catalog::entry* e = c.find(102);
+	assert(e);
+	assert_eq(2u, e->index);
+	assert_eq("/usr/lib/spa/multi.so", c.library(*e));
+
+	return 0;
+}
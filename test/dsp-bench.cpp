@@ -0,0 +1,72 @@
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <spa/audio.h>
+#include <spa/audio_dsp.h>
+
+//! benchmark for the dsp kernels, for all instruction sets that the CPU
+//! supports. Not run as a test, since the timing depends on the machine.
+
+namespace {
+
+const char* names[] = { "scalar", "sse2", "avx2", "avx512" };
+
+// fits into L1 cache, like a typical audio block
+constexpr std::size_t n = 1024;
+constexpr int rounds = 100000;
+
+template<class F>
+void bench(const char* name, F f)
+{
+	using clock = std::chrono::steady_clock;
+	const clock::time_point start = clock::now();
+	for(int i = 0; i < rounds; ++i)
+		f();
+	const double secs = std::chrono::duration<double>(
+		clock::now() - start).count();
+	std::printf("  %-14s %10.1f Msamples/s\n", name,
+		static_cast<double>(n) * rounds / secs / 1e6);
+}
+
+}
+
+int main()
+{
+	using namespace spa::audio;
+
+	aligned_buffer a, b, c, inter;
+	a.resize(n); b.resize(n); c.resize(n); inter.resize(2 * n);
+	for(std::size_t i = 0; i < n; ++i)
+		a[i] = static_cast<float>(i % 100) / 100.0f - 0.5f;
+	std::vector<int16_t> i16(n);
+	const float* planar[2] = { a.data(), b.data() };
+	float* const outs[2] = { b.data(), c.data() };
+	volatile float sink = 0.0f;
+
+	const simd_t best = simd();
+	for(int l = 0; l <= static_cast<int>(best); ++l)
+	{
+		const simd_t level = static_cast<simd_t>(l);
+		if(set_simd(level) != level)
+			continue;
+		std::printf("%s:\n", names[l]);
+		bench("gain", [&]{ gain(a.data(), b.data(), 0.5f, n); });
+		bench("gain_ramp", [&]{
+			gain_ramp(a.data(), b.data(), 0.0f, 1.0f / n, n); });
+		bench("mix", [&]{ mix(a.data(), b.data(), n); });
+		bench("mix_gain", [&]{ mix_gain(a.data(), b.data(), 0.5f, n); });
+		bench("pan", [&]{ pan(a.data(), b.data(), c.data(), 0.3f, n); });
+		bench("peak", [&]{ sink = peak(a.data(), n); });
+		bench("rms", [&]{ sink = rms(a.data(), n); });
+		bench("interleave", [&]{
+			interleave(planar, inter.data(), 2, n); });
+		bench("deinterleave", [&]{
+			deinterleave(inter.data(), outs, 2, n); });
+		bench("float->int16", [&]{ convert(a.data(), i16.data(), n); });
+		bench("int16->float", [&]{ convert(i16.data(), b.data(), n); });
+	}
+	set_simd(best);
+	(void)sink;
+
+	return 0;
+}
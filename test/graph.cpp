@@ -0,0 +1,377 @@
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <spa/graph.h>
+
+template<class T1, class T2>
+void assert_eq(const T1& exp, const T2& cur)
+{
+	if(exp != cur)
+	{
+		std::cerr << "Expected " << exp << " got " << cur << std::endl;
+		assert(exp == cur);
+	}
+}
+
+//! outputs a constant level, and sends it via OSC
+class source : public spa::plugin
+{
+	spa::audio::stereo::out out;
+	spa::audio::control_in<float> level;
+	spa::audio::osc_ringbuffer_out osc_out;
+	spa::audio::samplecount samplecount;
+
+	void run() override
+	{
+		for(unsigned i = 0; i < samplecount; ++i)
+			out.left[i] = out.right[i] = level;
+		if(level == 0.0f)
+			out.set_signal(spa::audio::signal_t::silent);
+		osc_out.ref().write("/gain", "f", static_cast<float>(level));
+	}
+
+	spa::port_ref_base& port(const char* path) override
+	{
+		switch(path[0])
+		{
+			case 'o': return path[1] == 'u' ? static_cast<
+				spa::port_ref_base&>(out) : osc_out;
+			case 'l': return level;
+			case 's': return samplecount;
+			default: throw spa::port_not_found(path);
+		}
+	}
+public:
+	static const char* const* port_names() {
+		static const char* const names[] = {
+			"out", "level", "osc-out", "samplecount", nullptr };
+		return names;
+	}
+};
+
+//! applies the gain received via OSC
+class amp : public spa::plugin
+{
+	spa::audio::stereo::in in;
+	spa::audio::stereo::out out;
+	spa::audio::osc_ringbuffer_in osc_in;
+	spa::audio::samplecount samplecount;
+	float gain = 1.0f;
+
+	void run() override
+	{
+		while(osc_in.read_msg())
+			gain = osc_in.arg(0).f;
+		for(unsigned i = 0; i < samplecount; ++i)
+		{
+			out.left[i] = gain * in.left[i];
+			out.right[i] = gain * in.right[i];
+		}
+	}
+
+	spa::port_ref_base& port(const char* path) override
+	{
+		switch(path[0])
+		{
+			case 'i': return in;
+			case 'o': return path[1] == 'u' ? static_cast<
+				spa::port_ref_base&>(out) : osc_in;
+			case 's': return samplecount;
+			default: throw spa::port_not_found(path);
+		}
+	}
+public:
+	amp() : osc_in(1024) {}
+	static const char* const* port_names() {
+		static const char* const names[] = {
+			"in", "out", "osc-in", "samplecount", nullptr };
+		return names;
+	}
+};
+
+//! generator that is only excited by OSC messages, and rings for a while
+class synth : public spa::plugin
+{
+	spa::audio::stereo::out out;
+	spa::audio::osc_ringbuffer_in osc_in;
+	spa::audio::tail_length tail;
+	spa::audio::samplecount samplecount;
+
+	void run() override
+	{
+		while(osc_in.read_msg())
+			;
+		++runs;
+		for(unsigned i = 0; i < samplecount; ++i)
+			out.left[i] = out.right[i] = 0.0f;
+	}
+
+	spa::port_ref_base& port(const char* path) override
+	{
+		switch(path[0])
+		{
+			case 'o': return path[1] == 'u' ? static_cast<
+				spa::port_ref_base&>(out) : osc_in;
+			case 't': return tail;
+			case 's': return samplecount;
+			default: throw spa::port_not_found(path);
+		}
+	}
+public:
+	static unsigned runs;
+	synth() : osc_in(1024) {}
+	void init() override { tail.set(200); }
+	static const char* const* port_names() {
+		static const char* const names[] = {
+			"out", "osc-in", "tail", "samplecount", nullptr };
+		return names;
+	}
+};
+unsigned synth::runs = 0;
+
+//! outputs an integer level unless it is muted, using non-float controls
+class stepper : public spa::plugin
+{
+	spa::audio::out out;
+	spa::audio::control_in<int> level;
+	spa::audio::atomic_control_in<bool> mute;
+	spa::audio::control_out<unsigned> runs;
+	spa::audio::samplecount samplecount;
+
+	void run() override
+	{
+		const float value = mute ? 0.0f : 0.125f * level;
+		for(unsigned i = 0; i < samplecount; ++i)
+			out[i] = value;
+		runs.set(runs + 1);
+	}
+
+	spa::port_ref_base& port(const char* path) override
+	{
+		switch(path[0])
+		{
+			case 'o': return out;
+			case 'l': return level;
+			case 'm': return mute;
+			case 'r': return runs;
+			case 's': return samplecount;
+			default: throw spa::port_not_found(path);
+		}
+	}
+public:
+	static const char* const* port_names() {
+		static const char* const names[] = {
+			"out", "level", "mute", "runs", "samplecount",
+			nullptr };
+		return names;
+	}
+};
+
+//! has a port of a type that the graph can not provide
+class sampler : public spa::plugin
+{
+	spa::audio::sample_in<int16_t> in;
+
+	void run() override {}
+	spa::port_ref_base& port(const char* ) override { return in; }
+public:
+	static const char* const* port_names() {
+		static const char* const names[] = { "in", nullptr };
+		return names;
+	}
+};
+
+template<class Plugin>
+class test_descriptor : public spa::descriptor
+{
+	SPA_DESCRIPTOR
+public:
+	test_descriptor(bool no_tail) {
+		properties.no_tail = no_tail;
+		properties.in_place = 1;
+	}
+
+	hoster_t hoster() const override { return hoster_t::localhost; }
+	const char* organization_url() const override { return "spa"; }
+	const char* project_url() const override { return "spa"; }
+	const char* label() const override { return "test"; }
+	const char* project() const override { return "spa"; }
+	const char* name() const override { return "test"; }
+	license_type license() const override {
+		return license_type::gpl_3_0; }
+	const char* const* port_name_table() const override {
+		return Plugin::port_names(); }
+	Plugin* instantiate() const override { return new Plugin; }
+};
+
+int main()
+{
+	using spa::host::graph;
+
+	// generators must not claim to have no tail
+	test_descriptor<source> src_desc(false);
+	test_descriptor<amp> amp_desc(true);
+
+	// two sources, mixed into one amp, which feeds another amp that
+	// gets its gain from the first source
+	graph g(64);
+	graph::node_id src1 = g.add(src_desc), src2 = g.add(src_desc);
+	graph::node_id amp2 = g.add(amp_desc), amp1 = g.add(amp_desc);
+	g.connect(src1, "out", amp1, "in");
+	g.connect(src2, "out", amp1, "in");
+	g.connect(amp1, "out", amp2, "in");
+	g.connect(src1, "osc-out", amp2, "osc-in");
+	g.set_control(src1, "level", 0.25f);
+	g.set_control(src2, "level", 0.5f);
+
+	// changed, but not compiled
+	bool thrown = false;
+	try { g.process(64); } catch(spa::exception& ) { thrown = true; }
+	assert(thrown);
+
+	g.compile();
+	g.osc(amp1, "osc-in").write("/gain", "f", 2.0f);
+	for(int block = 0; block < 3; ++block)
+	{
+		g.process(block + 16);
+		const float* out = g.output(amp2, "out", 1);
+		for(int i = 0; i < block + 16; ++i)
+			assert_eq(0.375f, out[i]);  // (.25 + .5) * 2 * .25
+	}
+	assert_eq(0u, g.skipped());
+
+	// silent sources let the graph skip amp1, but amp2 still gets
+	// OSC messages from src1
+	g.set_control(src1, "level", 0.0f);
+	g.set_control(src2, "level", 0.0f);
+	g.process(64);
+	g.process(64);
+	assert_eq(2u, g.skipped());
+	assert_eq(0.0f, g.output(amp2, "out", 0)[10]);
+
+	// unconnected inputs are filled by the host
+	g.remove(src1);
+	g.remove(src2);
+	thrown = false;
+	try { g.process(64); } catch(spa::exception& ) { thrown = true; }
+	assert(thrown);
+	g.compile();
+	float* in = g.input(amp1, "in", 0);
+	for(int i = 0; i < 64; ++i)
+		in[i] = 1.0f;
+	g.process(64);
+	assert_eq(0.0f, g.output(amp2, "out", 0)[0]); // gain still 0
+	g.osc(amp2, "osc-in").write("/gain", "f", 0.5f);
+	g.process(64);
+	assert_eq(1.0f, g.output(amp2, "out", 0)[63]); // 1 * 2 * .5
+	// the host can tell that it filled in silence
+	for(int i = 0; i < 64; ++i)
+		in[i] = 0.0f;
+	g.set_input_signal(amp1, "in", spa::audio::signal_t::silent);
+	const unsigned long skipped = g.skipped();
+	g.process(64);
+	g.process(64);
+	assert_eq(skipped + 4, g.skipped());
+	g.set_input_signal(amp1, "in", spa::audio::signal_t::normal);
+	g.process(64);
+	assert_eq(skipped + 4, g.skipped());
+
+	// a generator driven by events keeps running for its tail after
+	// the last event, even though it has no audio inputs
+	test_descriptor<synth> synth_desc(false);
+	graph events(64);
+	graph::node_id syn = events.add(synth_desc);
+	events.compile();
+	for(int block = 0; block < 10; ++block)
+		events.process(64);
+	assert_eq(4u, synth::runs); // 200 frames of tail after the start
+	events.osc(syn, "osc-in").write("/note", "f", 1.0f);
+	for(int block = 0; block < 10; ++block)
+		events.process(64);
+	// the block with the event, and the 200 frames after it
+	assert_eq(4u + 1u + 4u, synth::runs);
+	// a reset starts over, with the tail after the start
+	events.reset();
+	for(int block = 0; block < 10; ++block)
+		events.process(64);
+	assert_eq(4u + 1u + 4u + 4u, synth::runs);
+
+	// controls of other types than float
+	test_descriptor<stepper> stepper_desc(false);
+	graph steps(64);
+	graph::node_id st = steps.add(stepper_desc);
+	steps.compile();
+	steps.set_control(st, "level", 3);
+	steps.process(64);
+	assert_eq(0.375f, steps.output(st, "out", 0)[63]);
+	steps.set_control(st, "mute", 1);
+	steps.process(64);
+	assert_eq(0.0f, steps.output(st, "out", 0)[63]);
+
+	// ports without storage in the graph are refused
+	test_descriptor<sampler> sampler_desc(true);
+	thrown = false;
+	try { steps.add(sampler_desc); }
+	catch(spa::exception& ) { thrown = true; }
+	assert(thrown);
+
+	// cycles are not allowed
+	g.connect(amp2, "out", amp1, "in");
+	thrown = false;
+	try { g.compile(); } catch(spa::exception& ) { thrown = true; }
+	assert(thrown);
+
+	// parallel chains, mixed into one amp
+	graph p(64);
+	p.set_workers(3);
+	constexpr int chains = 16;
+	graph::node_id master = p.add(amp_desc);
+	for(int c = 0; c < chains; ++c)
+	{
+		graph::node_id s = p.add(src_desc), a = p.add(amp_desc),
+			b = p.add(amp_desc);
+		p.set_control(s, "level", 1.0f / 64 * c);
+		p.connect(s, "out", a, "in");
+		p.connect(a, "out", b, "in");
+		p.connect(b, "out", master, "in");
+		p.connect(s, "osc-out", b, "osc-in");
+	}
+	p.compile();
+	// sum of c/64 * c/64
+	float expected = 0.0f;
+	for(int c = 0; c < chains; ++c)
+		expected += (1.0f / 64 * c) * (1.0f / 64 * c);
+	for(int block = 0; block < 100; ++block)
+	{
+		p.process(64);
+		assert(std::fabs(p.output(master, "out", 0)[block % 64]
+			- expected) < 1e-6f);
+	}
+	// at most one buffer per channel and branch that can run in
+	// parallel, plus the mix buffer and output
+	assert(p.buffer_count() <= 2 * (chains + 2));
+	// the outputs of connected ports are reused
+	thrown = false;
+	try { p.output(master + 1, "out", 0); }
+	catch(spa::exception& ) { thrown = true; }
+	assert(thrown);
+
+	// a long chain of plugins that process in place only needs the
+	// buffers of the source
+	graph chain(64);
+	graph::node_id last = chain.add(src_desc);
+	chain.set_control(last, "level", 0.5f);
+	for(int i = 0; i < 100; ++i)
+	{
+		graph::node_id next = chain.add(amp_desc);
+		chain.connect(last, "out", next, "in");
+		last = next;
+	}
+	chain.compile();
+	chain.process(64);
+	assert_eq(2u, chain.buffer_count());
+	assert_eq(0.5f, chain.output(last, "out", 1)[63]);
+
+	return 0;
+}
@@ -0,0 +1,77 @@
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <spa/audio.h>
+
+template<class T1, class T2>
+void assert_eq(const T1& exp, const T2& cur)
+{
+	if(exp != cur)
+	{
+		std::cerr << "Expected " << exp << " got " << cur << std::endl;
+		assert(exp == cur);
+	}
+}
+
+int main()
+{
+	using namespace spa::audio;
+
+	// control lane (any number), event lane (2 msgs per block),
+	// bulk lane (1 message per block, by bytes)
+	const osc_lane_t cfg[] = {
+		{ 1024, 256, 0, 0 },
+		{ 1024, 256, 2, 0 },
+		{ 4096, 1024, 0, 64 } };
+	osc_lanes_in lanes(cfg, 3);
+	assert_eq(3u, lanes.lane_count());
+
+	osc_ringbuffer control(1024, 256), events(1024, 256),
+		bulk(4096, 1024);
+	lanes.lane(0).connect(control);
+	lanes.lane(1).connect(events);
+	lanes.lane(2).connect(bulk);
+
+	// the bulk message is longer than 256 bytes, so its length
+	// prefix uses more than one byte
+	char blob_data[300] = {};
+	pseudo_rtosc::rtosc_blob_t blob { 300,
+		reinterpret_cast<uint8_t*>(blob_data) };
+	bulk.write("/sample", "b", blob);
+	bulk.write("/sample", "b", blob);
+	events.write("/noteOn", "iii", 0, 69, 100);
+	events.write("/noteOn", "iii", 0, 70, 100);
+	events.write("/noteOn", "iii", 0, 71, 100);
+	control.write("/gain", "f", 0.5f);
+
+	// block 1: control first, then the 2 allowed events, then one blob
+	assert(lanes.read_msg());
+	assert_eq(0u, lanes.lane());
+	assert_eq(0, strcmp(lanes.path(), "/gain"));
+	assert(lanes.read_msg());
+	assert_eq(1u, lanes.lane());
+	assert_eq(69, lanes.arg(1).i);
+	assert(lanes.read_msg());
+	assert_eq(70, lanes.arg(1).i);
+	assert(lanes.read_msg());
+	assert_eq(2u, lanes.lane());
+	assert_eq(0, strcmp(lanes.types(), "b"));
+	assert_eq(300, lanes.arg(0).b.len);
+	assert(!lanes.read_msg());
+
+	// block 2: a new control message still goes first
+	control.write("/gain", "f", 1.0f);
+	assert(lanes.read_msg());
+	assert_eq(0u, lanes.lane());
+	assert(lanes.read_msg());
+	assert_eq(1u, lanes.lane());
+	assert_eq(71, lanes.arg(1).i);
+	assert(lanes.read_msg());
+	assert_eq(2u, lanes.lane());
+	assert(!lanes.read_msg());
+
+	// block 3: nothing left
+	assert(!lanes.read_msg());
+
+	return 0;
+}
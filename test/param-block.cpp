@@ -0,0 +1,69 @@
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include <spa/audio.h>
+
+template<class T1, class T2>
+void assert_eq(const T1& exp, const T2& cur)
+{
+	if(exp != cur)
+	{
+		std::cerr << "Expected " << exp << " got " << cur << std::endl;
+		assert(exp == cur);
+	}
+}
+
+int main()
+{
+	spa::audio::param_block block(130);
+	spa::audio::param_block_in port(130);
+	port.connect(block);
+
+	std::vector<unsigned> changed;
+	auto collect = [&](unsigned idx, float ) { changed.push_back(idx); };
+
+	// initially, every parameter is dirty
+	port.for_each_changed(collect);
+	assert_eq(130u, changed.size());
+	assert_eq(129u, changed.back());
+
+	changed.clear();
+	port.for_each_changed(collect);
+	assert(changed.empty());
+
+	block.set(3, 0.5f);
+	block.set(64, 1.0f);
+	block.set(129, 2.0f);
+	block.set(3, 0.25f);
+	port.for_each_changed([&](unsigned idx, float value) {
+		changed.push_back(idx);
+		assert_eq(block.get(idx), value);
+	});
+	assert_eq(3u, changed.size());
+	assert_eq(3u, changed[0]);
+	assert_eq(64u, changed[1]);
+	assert_eq(129u, changed[2]);
+	assert_eq(0.25f, port[3]);
+
+	// the dirty words start behind the rounded values, which must fit
+	// into the allocation
+	spa::audio::param_block odd(3);
+	spa::audio::param_block_in odd_port(3);
+	odd_port.connect(odd);
+	odd.set(2, 1.5f);
+	changed.clear();
+	odd_port.for_each_changed(collect);
+	assert_eq(3u, changed.size());
+	assert_eq(1.5f, odd_port[2]);
+
+	bool thrown = false;
+	spa::audio::param_block_in other(5);
+	try {
+		other.connect(block);
+	} catch(spa::exception& ) {
+		thrown = true;
+	}
+	assert(thrown);
+
+	return 0;
+}
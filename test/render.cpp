@@ -0,0 +1,231 @@
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <spa/audio.h>
+#include <spa/render.h>
+
+template<class T1, class T2>
+void assert_eq(const T1& exp, const T2& cur)
+{
+	if(exp != cur)
+	{
+		std::cerr << "Expected " << exp << " got " << cur << std::endl;
+		assert(exp == cur);
+	}
+}
+
+//! applies the gain received via OSC
+class amp : public spa::plugin
+{
+	spa::audio::stereo::in in;
+	spa::audio::stereo::out out;
+	spa::audio::osc_ringbuffer_in osc_in;
+	spa::audio::samplecount samplecount;
+	float gain = 1.0f;
+
+	void run() override
+	{
+		while(osc_in.read_msg())
+			gain = osc_in.arg(0).f;
+		for(unsigned i = 0; i < samplecount; ++i)
+		{
+			out.left[i] = gain * in.left[i];
+			out.right[i] = gain * in.right[i];
+		}
+	}
+
+	spa::port_ref_base& port(const char* path) override
+	{
+		switch(path[0])
+		{
+			case 'i': return in;
+			case 'o': return path[1] == 'u' ? static_cast<
+				spa::port_ref_base&>(out) : osc_in;
+			case 's': return samplecount;
+			default: throw spa::port_not_found(path);
+		}
+	}
+	// the render farm reuses the plugins for many files
+	void activate() override { gain = 1.0f; }
+public:
+	amp() : osc_in(1024) {}
+};
+
+class amp_descriptor : public spa::descriptor
+{
+	SPA_DESCRIPTOR
+public:
+	amp_descriptor() { properties.in_place = 1; }
+
+	hoster_t hoster() const override { return hoster_t::localhost; }
+	const char* organization_url() const override { return "spa"; }
+	const char* project_url() const override { return "spa"; }
+	const char* label() const override { return "amp"; }
+	const char* project() const override { return "spa"; }
+	const char* name() const override { return "amp"; }
+	license_type license() const override {
+		return license_type::gpl_3_0; }
+	const char* const* port_name_table() const override {
+		static const char* const names[] = {
+			"in", "out", "osc-in", "samplecount", nullptr };
+		return names;
+	}
+	amp* instantiate() const override { return new amp; }
+};
+
+//! write @p frames frames of a constant @p level
+void write_input(const char* path, unsigned channels, std::size_t frames,
+	float level)
+{
+	spa::host::wav_writer out(path, channels, 44100);
+	std::vector<float> buf(frames * channels, level);
+	out.write(buf.data(), frames);
+}
+
+std::vector<float> read_all(const char* path, unsigned channels)
+{
+	spa::host::wav_reader in(path);
+	assert_eq(channels, in.channels());
+	assert_eq(44100, in.samplerate());
+	std::vector<float> res(in.frames() * channels);
+	assert_eq(in.frames(), in.read(res.data(), in.frames()));
+	assert_eq(0u, in.read(res.data(), 1));
+	return res;
+}
+
+int main()
+{
+	using namespace spa::host;
+	amp_descriptor desc;
+	const std::vector<const spa::descriptor*> chain = { &desc, &desc };
+
+	{
+		std::ofstream automation("render-automation.txt");
+		automation << "# halve the gain of the second amp\n"
+			"\n"
+			"100 1 osc-in /gain f 0.5\n"
+			"20 0 osc-in /gain f 2\n";
+	}
+	const std::vector<automation_event> events =
+		load_automation("render-automation.txt");
+	assert_eq(2u, events.size());
+	assert_eq(20u, events[0].frame);
+	assert_eq(1u, events[1].node);
+
+	render_options options;
+	options.block = 64; // the events are inside of blocks
+	options.tail_seconds = 0.01; // 441 frames
+	options.in_port = "in";
+	options.out_port = "out";
+
+	// mono input, which is fed into both channels
+	write_input("render-in.wav", 1, 1000, 0.25f);
+	render_stats stats = render(chain, "render-in.wav", "render-out.wav",
+		events, options);
+	assert_eq(1441u, stats.frames);
+	assert_eq(2u, stats.channels);
+
+	std::vector<float> res = read_all("render-out.wav", 2);
+	assert_eq(2882u, res.size());
+	for(std::size_t i = 0; i < res.size(); ++i)
+	{
+		const std::size_t frame = i / 2;
+		assert_eq(frame < 20 ? 0.25f : frame < 100 ? 0.5f
+			: frame < 1000 ? 0.25f : 0.0f, res[i]);
+	}
+
+	// 16 bit output, with dither
+	options.format = wav_writer::format::int16;
+	options.tail_seconds = 0;
+	write_input("render-in.wav", 2, 500, 0.25f);
+	stats = render(chain, "render-in.wav", "render-out.wav", {},
+		options);
+	assert_eq(500u, stats.frames);
+	res = read_all("render-out.wav", 2);
+	for(float f : res)
+		assert(std::fabs(f - 0.25f) < 3.0f / 32768);
+
+	bool thrown;
+
+	// more automation at once than the plugin's ringbuffer can hold
+	options.format = wav_writer::format::float32;
+	const std::vector<automation_event> burst(200, events[0]);
+	render(chain, "render-in.wav", "render-out.wav", burst, options);
+	res = read_all("render-out.wav", 2);
+	for(std::size_t i = 0; i < res.size(); ++i)
+		assert_eq(i / 2 < 20 ? 0.25f : 0.5f, res[i]);
+
+	// WAV files can not hold more than 4 GiB, nothing of the samples is
+	// read then
+	{
+		wav_writer big("render-big.wav", 2, 44100);
+		thrown = false;
+		try {
+			big.write(nullptr, std::size_t(1) << 29);
+		} catch(spa::exception& ) { thrown = true; }
+		assert(thrown);
+	}
+	assert_eq(0u, read_all("render-big.wav", 2).size());
+	std::remove("render-big.wav");
+
+	// automation after the end of input and tail
+	thrown = false;
+	options.tail_seconds = 0.01;
+	try {
+		render(chain, "render-in.wav", "render-out.wav",
+			{ automation_event { 941, 0, "osc-in",
+				events[0].msg } }, options);
+	} catch(spa::exception& ) { thrown = true; }
+	assert(thrown);
+	options.tail_seconds = 0;
+
+	// wrong input
+	thrown = false;
+	try {
+		render(chain, "render-automation.txt", "render-out.wav");
+	} catch(spa::exception& ) { thrown = true; }
+	assert(thrown);
+
+	// render farm, with one job that fails, all jobs are long enough for
+	// the automation
+	options.format = wav_writer::format::float32;
+	std::vector<render_job> jobs(5);
+	for(std::size_t i = 0; i < jobs.size(); ++i)
+	{
+		jobs[i].in = "render-in-" + std::to_string(i) + ".wav";
+		jobs[i].out = "render-out-" + std::to_string(i) + ".wav";
+		if(i != 3)
+			write_input(jobs[i].in.c_str(), 2, 100 * (i + 2),
+				0.125f * i);
+	}
+	farm_options farm;
+	farm.workers = 3;
+	const farm_stats fstats = render_farm(chain, jobs, events, options,
+		farm);
+	assert_eq(3u, fstats.workers);
+	assert_eq(1u, fstats.failed);
+	assert_eq(1500u, fstats.frames);
+	assert_eq(3000u, fstats.samples);
+	for(std::size_t i = 0; i < jobs.size(); ++i)
+	{
+		assert_eq(i == 3, !jobs[i].error.empty());
+		if(i == 3)
+			continue;
+		res = read_all(jobs[i].out.c_str(), 2);
+		assert_eq(200 * (i + 2), res.size());
+		// the automation applies to each job
+		for(std::size_t s = 0; s < res.size(); ++s)
+			assert_eq((s / 2 >= 20 && s / 2 < 100 ? 0.25f : 0.125f)
+				* i, res[s]);
+		std::remove(jobs[i].in.c_str());
+		std::remove(jobs[i].out.c_str());
+	}
+
+	std::remove("render-automation.txt");
+	std::remove("render-in.wav");
+	std::remove("render-out.wav");
+
+	return 0;
+}
@@ -46,5 +46,47 @@ int main()
 	assert_eq(16u, rb.write_space());
 	assert_eq(0u, reader.read_space());
 
+	// switching to a larger ringbuffer keeps unread data
+	{
+		spa::ringbuffer<char> small(8), large(32);
+		spa::ringbuffer_in<char> rd_in(8);
+		rd_in.connect(small);
+		small.write("abcdefgh", 8);
+		assert_eq(0u, small.write_space());
+		rd_in.read(3);
+
+		rd_in.switch_to(large);
+		assert_eq(32u, rd_in.get_size());
+		assert_eq(5u, rd_in.read_space());
+		assert_eq(27u, large.write_space());
+		large.write("ij", 3);
+
+		rd_in.read(8).copy(buf, 8);
+		assert_eq(0, strcmp(buf, "defghij"));
+		assert_eq(0u, rd_in.read_space());
+	}
+
+	// shared blobs: host sends a handle, plugin gives the blob back
+	{
+		spa::blob_return_ringbuffer returned(4);
+		spa::blob_return_out port;
+		port.ref = &returned;
+
+		spa::shared_blob* blob = new spa::shared_blob(8);
+		blob->ref(); // for the plugin
+		int64_t handle = blob->handle();
+
+		spa::shared_blob* received =
+			spa::shared_blob::from_handle(handle);
+		assert_eq(blob, received);
+		assert_eq(8u, received->size());
+		assert(port.give_back(received));
+		assert_eq(3u, returned.write_space());
+
+		returned.collect(); // drops the plugin's reference
+		assert_eq(4u, returned.write_space());
+		blob->release(); // drops the host's reference
+	}
+
 	return 0;
 }
@@ -0,0 +1,116 @@
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <spa/scan_cache.h>
+
+template<class T1, class T2>
+void assert_eq(const T1& exp, const T2& cur)
+{
+	if(exp != cur)
+	{
+		std::cerr << "Expected " << exp << " got " << cur << std::endl;
+		assert(exp == cur);
+	}
+}
+
+static unsigned scans = 0;
+
+spa::host::library_info counting_scan(const std::string& path)
+{
+	++scans;
+	return spa::host::scan_library(path);
+}
+
+void copy_file(const char* from, const char* to)
+{
+	std::ifstream in(from, std::ios::binary);
+	std::ofstream out(to, std::ios::binary | std::ios::trunc);
+	out << in.rdbuf();
+}
+
+int main(int argc, char** argv)
+{
+	using spa::host::scan_cache;
+	using spa::host::library_info;
+	assert_eq(2, argc);
+
+	// work on a copy, which we can touch and remove
+	const char* cache_file = "scan-cache.idx";
+	const std::string lib = "./scan-cache-plugin.so";
+	std::remove(cache_file);
+	copy_file(argv[1], lib.c_str());
+
+	{
+		scan_cache c(cache_file, &counting_scan);
+		assert_eq(0u, c.size());
+		const library_info& info = c.lookup(lib);
+		assert_eq(1u, scans);
+		assert(info.error.empty());
+		assert_eq(1u, info.plugins.size());
+		assert_eq("Example Plugin", info.plugins[0].name);
+		assert_eq(spa::plugin_id("github.com", "JohannesLorenz", "spa",
+			"master", "example-plugin"), info.plugins[0].id);
+		assert_eq(4u, info.plugins[0].port_names.size());
+		assert_eq("osc", info.plugins[0].port_names[3]);
+		assert(info.plugins[0].properties.no_tail);
+		assert(!info.plugins[0].properties.realtime_dependency);
+
+		// only scanned once per change
+		c.lookup(lib);
+		assert_eq(1u, scans);
+
+		// broken libraries are remembered, too
+		std::ofstream("scan-cache-broken.so") << "no library";
+		assert(!c.lookup("scan-cache-broken.so").error.empty());
+		assert_eq(2u, scans);
+
+		bool thrown = false;
+		try { c.lookup("scan-cache-missing.so"); }
+		catch(spa::exception& ) { thrown = true; }
+		assert(thrown);
+		c.save();
+		assert(!c.changed());
+	}
+
+	{
+		// a new host start does not load anything
+		scan_cache c(cache_file, &counting_scan);
+		assert_eq(2u, c.size());
+		const library_info& info = c.lookup(lib);
+		assert_eq(2u, scans);
+		assert_eq("Example Plugin", info.plugins[0].name);
+		assert(info.plugins[0].properties.in_place);
+		assert(!c.lookup("scan-cache-broken.so").error.empty());
+		assert_eq(2u, scans);
+
+		// changed libraries are scanned again
+		const timespec times[2] = { { 1000, 0 }, { 1000, 0 } };
+		utimensat(AT_FDCWD, lib.c_str(), times, 0);
+		const std::vector<std::string> stale =
+			c.stale({ lib, "scan-cache-broken.so" });
+		assert_eq(1u, stale.size());
+		assert_eq(lib, stale[0]);
+		c.lookup(lib);
+		assert_eq(3u, scans);
+
+		std::remove("scan-cache-broken.so");
+		c.prune();
+		assert_eq(1u, c.size());
+		c.save();
+	}
+
+	{
+		// corrupt files are ignored
+		std::ofstream(cache_file, std::ios::app) << "garbage";
+		scan_cache c(cache_file, &counting_scan);
+		assert_eq(0u, c.size());
+		assert(c.changed());
+	}
+
+	std::remove(cache_file);
+	std::remove(lib.c_str());
+	return 0;
+}
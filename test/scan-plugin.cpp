@@ -0,0 +1,65 @@
+//! libraries for testing the scanner, see scanner.cpp
+
+#include <csignal>
+#include <string>
+#include <unistd.h>
+#include <spa/spa.h>
+
+#if defined(SCAN_MULTI)
+//! one of multiple plugins in this library, without any function
+class multi_descriptor : public spa::descriptor
+{
+	SPA_DESCRIPTOR
+	std::string label_str, name_str;
+public:
+	multi_descriptor(unsigned long index) :
+		label_str("multi-" + std::to_string(index)),
+		name_str("Multi " + std::to_string(index)) {}
+
+	hoster_t hoster() const override { return hoster_t::localhost; }
+	const char* organization_url() const override { return "spa"; }
+	const char* project_url() const override { return "spa"; }
+	const char* label() const override { return label_str.c_str(); }
+	const char* project() const override { return "spa"; }
+	const char* name() const override { return name_str.c_str(); }
+	license_type license() const override {
+		return license_type::lgpl_2_1; }
+	const char* const* port_name_table() const override {
+		static const char* const names[] = { "in", "out", nullptr };
+		return names;
+	}
+	spa::plugin* instantiate() const override { return nullptr; }
+};
+
+//! a descriptor whose precomputed ID is wrong
+class wrong_id_descriptor : public multi_descriptor
+{
+public:
+	wrong_id_descriptor() : multi_descriptor(3) {}
+	std::uint64_t id() const override { return 42; }
+};
+#endif
+
+extern "C" {
+
+spa::descriptor* spa_descriptor(unsigned long index)
+{
+#if defined(SCAN_CRASH)
+	raise(SIGSEGV);
+#elif defined(SCAN_HANG)
+	for(;;)
+		pause();
+#elif defined(SCAN_MULTI)
+	if(index < 3)
+		return new multi_descriptor(index);
+	// skipped, but the plugins after it are still found
+	if(index == 3)
+		return new wrong_id_descriptor;
+	if(index == 4)
+		return new multi_descriptor(index);
+#endif
+	(void)index;
+	return nullptr;
+}
+
+}
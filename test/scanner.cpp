@@ -0,0 +1,74 @@
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <spa/scanner.h>
+
+template<class T1, class T2>
+void assert_eq(const T1& exp, const T2& cur)
+{
+	if(exp != cur)
+	{
+		std::cerr << "Expected " << exp << " got " << cur << std::endl;
+		assert(exp == cur);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	using spa::host::library_info;
+	assert_eq(5, argc);
+	const char *plugin = argv[1], *crash = argv[2], *hang = argv[3],
+		*multi = argv[4];
+	std::ofstream("scanner-broken.so") << "no library";
+
+	spa::host::scanner s(2, 500);
+	assert_eq(2u, s.jobs());
+	const std::vector<library_info> res = s.scan({ crash, plugin, hang,
+		"./scanner-broken.so", plugin, "./scanner-missing.so" });
+	assert_eq(6u, res.size());
+
+	// the workers survive valid libraries, and are restarted after
+	// a crash or a timeout
+	for(std::size_t i : { 1, 4 })
+	{
+		assert_eq(plugin, res[i].path);
+		assert(res[i].error.empty());
+		assert_eq(1u, res[i].plugins.size());
+		assert_eq("Example Plugin", res[i].plugins[0].name);
+		assert_eq("osc", res[i].plugins[0].port_names[3]);
+	}
+	assert_eq(crash, res[0].path);
+	assert(std::strstr(res[0].error.c_str(), "crashed"));
+	// crashed libraries can be cached
+	assert(res[0].size);
+	assert_eq("timed out", res[2].error);
+	assert(!res[3].error.empty());
+	assert(!res[5].error.empty());
+
+	assert(s.scan({}).empty());
+
+	// all plugins of a library are enumerated, and a broken one (index
+	// 3) does not make the whole library fail
+	const library_info info = s.scan({ multi })[0];
+	assert(info.error.empty());
+	assert_eq(4u, info.plugins.size());
+	assert_eq(4u, info.plugins[3].index);
+	for(unsigned long i = 0; i < 3; ++i)
+	{
+		const spa::host::plugin_info& p = info.plugins[i];
+		assert_eq(i, p.index);
+		assert_eq("Multi " + std::to_string(i), p.name);
+		assert_eq("github.com::spa::spa::master::multi-" +
+			std::to_string(i), p.unique_name);
+		assert(p.license == spa::descriptor::license_type::lgpl_2_1);
+		// the default ID is the hash of the unique name
+		assert_eq(spa::detail::fnv1a(p.unique_name.c_str()), p.id);
+		// read from the static table
+		assert_eq(2u, p.port_names.size());
+		assert_eq("out", p.port_names[1]);
+	}
+
+	std::remove("scanner-broken.so");
+	return 0;
+}
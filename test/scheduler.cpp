@@ -0,0 +1,84 @@
+#include <atomic>
+#include <cassert>
+#include <iostream>
+#include <vector>
+#include <spa/scheduler.h>
+
+template<class T1, class T2>
+void assert_eq(const T1& exp, const T2& cur)
+{
+	if(exp != cur)
+	{
+		std::cerr << "Expected " << exp << " got " << cur << std::endl;
+		assert(exp == cur);
+	}
+}
+
+struct dag
+{
+	std::vector<std::vector<unsigned>> successors, predecessors;
+	std::vector<std::atomic<unsigned>> runs;
+	std::atomic<unsigned> order_errors;
+
+	dag(unsigned n) : successors(n), predecessors(n), runs(n),
+		order_errors(0) {}
+
+	void connect(unsigned from, unsigned to)
+	{
+		successors[from].push_back(to);
+		predecessors[to].push_back(from);
+	}
+
+	static void task(void* ctx, unsigned t)
+	{
+		dag& d = *static_cast<dag*>(ctx);
+		const unsigned round = d.runs[t].load();
+		// all predecessors must have run in this round already
+		for(unsigned p : d.predecessors[t])
+			if(d.runs[p].load() != round + 1)
+				++d.order_errors;
+		d.runs[t].fetch_add(1);
+	}
+};
+
+int main()
+{
+	using spa::host::scheduler;
+
+	// many parallel chains that end in one mixing task, plus some
+	// pseudo random edges across the chains
+	constexpr unsigned chains = 16, length = 8;
+	constexpr unsigned n = chains * length + 1;
+	dag d(n);
+	for(unsigned c = 0; c < chains; ++c)
+	{
+		for(unsigned i = 1; i < length; ++i)
+			d.connect(c * length + i - 1, c * length + i);
+		d.connect(c * length + length - 1, n - 1);
+		if(c)
+			d.connect((c * 7) % (chains * length / 2),
+				c * length + length / 2);
+	}
+
+	for(unsigned workers = 0; workers < 4; ++workers)
+	{
+		scheduler s(workers);
+		assert_eq(workers, s.workers());
+		s.prepare(d.successors);
+		for(auto& r : d.runs)
+			r.store(0);
+		constexpr unsigned rounds = 1000;
+		for(unsigned r = 0; r < rounds; ++r)
+			s.run(&dag::task, &d);
+		for(auto& r : d.runs)
+			assert_eq(rounds, r.load());
+		assert_eq(0u, d.order_errors.load());
+	}
+
+	// an empty graph must not block
+	scheduler s(2);
+	s.prepare({});
+	s.run(&dag::task, &d);
+
+	return 0;
+}
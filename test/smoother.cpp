@@ -0,0 +1,81 @@
+#include <cassert>
+#include <cmath>
+#include <iostream>
+#include <spa/audio.h>
+
+template<class T1, class T2>
+void assert_eq(const T1& exp, const T2& cur)
+{
+	if(exp != cur)
+	{
+		std::cerr << "Expected " << exp << " got " << cur << std::endl;
+		assert(exp == cur);
+	}
+}
+
+void assert_near(float exp, float cur)
+{
+	if(std::fabs(exp - cur) > 1e-4f)
+	{
+		std::cerr << "Expected " << exp << " got " << cur << std::endl;
+		assert(false);
+	}
+}
+
+int main()
+{
+	using namespace spa::audio;
+	float buf[8];
+
+	// linear: the first target is jumped to, later ones are ramped
+	smoother<float> lin(4);
+	lin.set_target(1.0f);
+	assert(lin.steady());
+	assert_eq(1.0f, lin.value());
+	lin.set_target(2.0f);
+	assert(!lin.steady());
+	lin.render(buf, 2);
+	assert_near(1.25f, buf[0]);
+	assert_near(1.5f, buf[1]);
+	lin.render(buf, 4);
+	assert_near(1.75f, buf[0]);
+	assert_eq(2.0f, buf[1]);
+	assert_eq(2.0f, buf[3]);
+	assert(lin.steady());
+
+	// logarithmic scale: the ramp is geometric
+	control_in<float> port;
+	port.scale_type = scale_type_t::logartihmic;
+	smoother<float> geo(port, 2);
+	geo.set_target(100.0f);
+	geo.set_target(10000.0f);
+	geo.render(buf, 3);
+	assert_near(1000.0f / 10000.0f, buf[0] / 10000.0f);
+	assert_eq(10000.0f, buf[1]);
+	assert_eq(10000.0f, buf[2]);
+
+	// exponential: approaches the target and then snaps to it
+	smoother<float> ex(1, smoothing_t::exponential);
+	ex.set_target(0.0f);
+	ex.set_target(1.0f);
+	for(int i = 0; i < 4 && !ex.steady(); ++i)
+		ex.render(buf, 8);
+	assert(ex.steady());
+	assert_eq(1.0f, ex.value());
+
+	// sample accurate automation: set at frame 1, ramp in frames 3..4
+	float value = 0.0f;
+	const control_segment<float> segs[] = { { 1, 0, 1.0f },
+		{ 3, 2, 2.0f } };
+	automatable_in<float> automated;
+	automated.set_ref(&value);
+	assert(automated.steady());
+	automated.segments = segs;
+	automated.segment_count = 2;
+	automated.render(buf, 6);
+	const float exp_automated[] = { 0.0f, 1.0f, 1.0f, 1.5f, 2.0f, 2.0f };
+	for(int i = 0; i < 6; ++i)
+		assert_eq(exp_automated[i], buf[i]);
+
+	return 0;
+}
@@ -0,0 +1,243 @@
+/*************************************************************************/
+/* spa-render.cpp - render audio files through plugins                   */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+
+/**
+	@file spa-render.cpp
+	renders WAV files through a chain of plugins, faster than realtime
+*/
+
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <getopt.h>
+#include <spa/render.h>
+
+void usage()
+{
+	std::cout << "usage: spa-render [-b <block>] [-q <queue>] "
+		"[-t <tail seconds>] [-f f32|s16|s24] [-a <automation>]\n"
+		"                  [-i <in port>] [-o <out port>] "
+		"<in.wav> <out.wav> <library[:index]>...\n"
+		"       spa-render [options] -d <out folder> "
+		"[-j <workers>] [-P] <in.wav>... <library[:index]>...\n"
+		"\n"
+		"With -d, all input files are rendered in parallel, into "
+		"files with the same\n"
+		"names in the output folder. -P disables pinning the "
+		"workers to CPUs.\n"
+		"Blocks can have 1 to 1048576 frames, the queue 1 to 1024 "
+		"blocks, and there\n"
+		"can be 1 to 4096 workers.\n" << std::endl;
+	exit(0);
+}
+
+//! parse the number @p arg, which must be in [1, @p max], or print the
+//! usage
+unsigned positive(const char* arg, unsigned long max)
+{
+	char* end;
+	errno = 0;
+	// strtoul would accept negative numbers
+	const unsigned long value = std::isdigit(*arg)
+		? std::strtoul(arg, &end, 10) : 0;
+	if(!value || *end || errno || value > max)
+		usage();
+	return static_cast<unsigned>(value);
+}
+
+//! @p path with its folder resolved, so the same file always gets the
+//! same name, even if it does not exist yet
+std::string resolve(const std::string& path)
+{
+	const std::size_t slash = path.rfind('/');
+	const std::string folder = slash == std::string::npos ? "."
+		: slash ? path.substr(0, slash) : "/";
+	char* real = realpath(folder.c_str(), nullptr);
+	if(!real)
+		return path;
+	std::string res = real;
+	std::free(real);
+	if(res.back() != '/')
+		res += '/';
+	return res + path.substr(slash + 1);
+}
+
+int main(int argc, char** argv)
+{
+	spa::host::render_options options;
+	const char* automation_file = nullptr;
+	const char* out_folder = nullptr;
+	spa::host::farm_options farm;
+	const char* optstring = "b:q:t:f:a:i:o:d:j:Ph";
+	for(int opt; (opt = getopt(argc, argv, optstring)) != -1; )
+	{
+		using format = spa::host::wav_writer::format;
+		switch(opt)
+		{
+			case 'b':
+				options.block = positive(optarg, 1 << 20);
+				break;
+			case 'q':
+				options.queue = positive(optarg, 1024);
+				break;
+			case 't':
+				options.tail_seconds = std::atof(optarg);
+				break;
+			case 'f':
+				if(!strcmp(optarg, "s16"))
+					options.format = format::int16;
+				else if(!strcmp(optarg, "s24"))
+					options.format = format::int24;
+				else if(strcmp(optarg, "f32"))
+					usage();
+				break;
+			case 'a': automation_file = optarg; break;
+			case 'i': options.in_port = optarg; break;
+			case 'o': options.out_port = optarg; break;
+			case 'd': out_folder = optarg; break;
+			case 'j':
+				farm.workers = positive(optarg, 4096);
+				break;
+			case 'P': farm.pin = false; break;
+			default: usage();
+		}
+	}
+	if(argc - optind < (out_folder ? 2 : 3))
+		usage();
+
+	// the files (input and output without -d) and the plugin libraries
+	std::vector<std::string> inputs, libraries;
+	for(int i = optind; i < argc; ++i)
+	{
+		const std::string arg = argv[i];
+		const bool wav = arg.size() > 4 &&
+			!arg.compare(arg.size() - 4, 4, ".wav");
+		if(out_folder ? wav : i < optind + 2)
+			inputs.push_back(arg);
+		else
+			libraries.push_back(arg);
+	}
+	if(inputs.empty() || libraries.empty())
+		usage();
+
+	// the output files, which must neither overwrite an input nor
+	// each other
+	std::vector<std::string> outputs;
+	if(out_folder)
+		for(const std::string& in : inputs)
+			outputs.push_back(std::string(out_folder) + "/" +
+				in.substr(in.rfind('/') + 1));
+	else
+	{
+		outputs.push_back(inputs[1]);
+		inputs.pop_back();
+	}
+	std::set<std::string> files;
+	for(const std::string& in : inputs)
+		files.insert(resolve(in));
+	for(const std::string& out : outputs)
+		if(!files.insert(resolve(out)).second)
+		{
+			std::cerr << out << ": output file would overwrite "
+				"an input or another output" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+	int rc = EXIT_SUCCESS;
+	try
+	{
+		using namespace spa::host;
+		// each library is loaded once, and shared by all workers
+		std::vector<std::unique_ptr<plugin_library>> libs;
+		std::vector<const spa::descriptor*> chain;
+		for(std::string& path : libraries)
+		{
+			// the index of the plugin follows the last colon
+			unsigned long index = 0;
+			const std::size_t colon = path.rfind(':');
+			if(colon != std::string::npos)
+			{
+				index = std::strtoul(path.c_str() + colon + 1,
+					nullptr, 10);
+				path.resize(colon);
+			}
+			libs.emplace_back(new plugin_library(path, index));
+			chain.push_back(&libs.back()->descriptor());
+		}
+
+		std::vector<automation_event> automation;
+		if(automation_file)
+			automation = load_automation(automation_file);
+
+		if(out_folder)
+		{
+			std::vector<render_job> jobs(inputs.size());
+			for(std::size_t i = 0; i < jobs.size(); ++i)
+			{
+				jobs[i].in = inputs[i];
+				jobs[i].out = outputs[i];
+			}
+			const farm_stats stats = render_farm(chain, jobs,
+				automation, options, farm);
+			for(const render_job& job : jobs)
+				if(!job.error.empty())
+				{
+					std::cerr << job.in << ": " << job.error
+						<< std::endl;
+					rc = EXIT_FAILURE;
+				}
+			std::cout << jobs.size() << " files (" << stats.failed
+				<< " failed), " << stats.frames << " frames in "
+				<< stats.seconds << " s with " << stats.workers
+				<< " workers, " << stats.samples_per_second()
+				<< " samples/s" << std::endl;
+		}
+		else
+		{
+			const render_stats stats = render(chain, inputs[0],
+				outputs[0], automation, options);
+			const double audio_seconds = double(stats.frames)
+				/ wav_reader(inputs[0]).samplerate();
+			std::cout << stats.frames << " frames ("
+				<< audio_seconds << " s) of " << stats.channels
+				<< " channels in " << stats.seconds << " s, "
+				<< audio_seconds / stats.seconds
+				<< "x realtime, " << stats.io_wait
+				<< " s waiting for I/O" << std::endl;
+		}
+	}
+	catch (const spa::exception& e) {
+		std::cerr << "caught spa::exception: " << e.what()
+			<< std::endl;
+		rc = EXIT_FAILURE;
+	}
+	catch (const std::exception& e) {
+		std::cerr << "caught std::exception: " << e.what() << std::endl;
+		rc = EXIT_FAILURE;
+	}
+
+	return rc;
+}
@@ -0,0 +1,143 @@
+/*************************************************************************/
+/* spa-scan.cpp - index the plugins in libraries                         */
+/* Copyright (C) 2018                                                    */
+/* Johannes Lorenz (j.git$$$lorenz-ho.me, $$$=@)                         */
+/*                                                                       */
+/* This program is free software; you can redistribute it and/or modify  */
+/* it under the terms of the GNU General Public License as published by  */
+/* the Free Software Foundation; either version 3 of the License, or (at */
+/* your option) any later version.                                       */
+/* This program is distributed in the hope that it will be useful, but   */
+/* WITHOUT ANY WARRANTY; without even the implied warranty of            */
+/* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU      */
+/* General Public License for more details.                              */
+/*                                                                       */
+/* You should have received a copy of the GNU General Public License     */
+/* along with this program; if not, write to the Free Software           */
+/* Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110, USA  */
+/*************************************************************************/
+
+
+/**
+	@file spa-scan.cpp
+	scans plugin libraries in parallel, in separate processes
+*/
+
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <ftw.h>
+#include <getopt.h>
+#include <spa/scanner.h>
+
+static std::vector<std::string> libraries;
+
+static int add_library(const char* path, const struct stat* ,
+	int type, struct FTW* )
+{
+	const std::string p = path;
+	if(type == FTW_F && p.size() > 3 && !p.compare(p.size() - 3, 3, ".so"))
+		libraries.push_back(p);
+	return 0;
+}
+
+void usage()
+{
+	std::cout << "usage: spa-scan [-j <jobs>] [-t <timeout ms>] "
+		"[-c <cache file>] <library or folder>...\n" << std::endl;
+	exit(0);
+}
+
+int main(int argc, char** argv)
+{
+	unsigned jobs = 0, timeout_ms = 10000;
+	const char* cache_file = nullptr;
+	for(int opt; (opt = getopt(argc, argv, "j:t:c:h")) != -1; )
+	{
+		switch(opt)
+		{
+			case 'j': jobs = std::atoi(optarg); break;
+			case 't': timeout_ms = std::atoi(optarg); break;
+			case 'c': cache_file = optarg; break;
+			default: usage();
+		}
+	}
+	if(optind == argc)
+		usage();
+
+	// the cache is keyed by absolute paths
+	for(int i = optind; i < argc; ++i)
+	{
+		char abs_path[PATH_MAX];
+		if(!realpath(argv[i], abs_path) ||
+			nftw(abs_path, &add_library, 16, FTW_PHYS))
+		{
+			perror(argv[i]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	int rc = EXIT_SUCCESS;
+	try
+	{
+		using spa::host::library_info;
+		spa::host::scanner scanner(jobs, timeout_ms);
+		const auto start = std::chrono::steady_clock::now();
+
+		std::vector<library_info> results;
+		std::size_t scanned = libraries.size();
+		if(cache_file)
+		{
+			// only scan what is new or has changed
+			spa::host::scan_cache cache(cache_file);
+			const std::vector<std::string> stale =
+				cache.stale(libraries);
+			scanned = stale.size();
+			for(library_info& info : scanner.scan(stale))
+				cache.insert(std::move(info));
+			cache.prune();
+			cache.save();
+			for(const std::string& path : libraries)
+				results.push_back(cache.lookup(path));
+		}
+		else
+			results = scanner.scan(libraries);
+
+		const auto end = std::chrono::steady_clock::now();
+
+		std::size_t plugins = 0, errors = 0;
+		for(const library_info& info : results)
+		{
+			std::cout << info.path << std::endl;
+			if(!info.error.empty())
+			{
+				std::cout << "  error: " << info.error << std::endl;
+				++errors;
+			}
+			for(const spa::host::plugin_info& p : info.plugins)
+				std::cout << "  " << p.unique_name << ": "
+					<< p.name << std::endl;
+			plugins += info.plugins.size();
+		}
+		std::cout << results.size() << " libraries, " << plugins
+			<< " plugins, " << errors << " errors, scanned "
+			<< scanned << " libraries with " << scanner.jobs()
+			<< " jobs in " << std::chrono::duration_cast<
+				std::chrono::milliseconds>(end - start).count()
+			<< " ms" << std::endl;
+	}
+	catch (const spa::exception& e) {
+		std::cerr << "caught spa::exception: " << e.what()
+			<< std::endl;
+		rc = EXIT_FAILURE;
+	}
+	catch (const std::exception& e) {
+		std::cerr << "caught std::exception: " << e.what() << std::endl;
+		rc = EXIT_FAILURE;
+	}
+
+	return rc;
+}